@@ -76,6 +76,9 @@ namespace sigmaengine { namespace app {
        std::shared_ptr< api_session_data > session = _ctx.session.lock();
        FC_ASSERT( session );
 
+       if( session->budget )
+          session->budget->set_limits( acc->limits );
+
        std::map< std::string, api_ptr >& _api_map = session->api_map;
 
        for( const std::string& api_name : acc->allowed_apis )
@@ -125,9 +128,15 @@ namespace sigmaengine { namespace app {
 
     void network_broadcast_api::on_api_startup()
     {
+    }
+
+    void network_broadcast_api::subscribe_applied_block()
+    {
+       /// Sessions only listen for blocks while they have confirmations pending, so idle sessions cost nothing per block.
        /// note cannot capture shared pointer here, because _applied_block_connection will never
        /// be freed if the lambda holds a reference to it.
-       _applied_block_connection = connect_signal( _app.chain_database()->applied_block, *this, &network_broadcast_api::on_applied_block );
+       if( !_applied_block_connection.connected() )
+          _applied_block_connection = connect_signal( _app.applied_block_notice, *this, &network_broadcast_api::on_applied_block );
     }
 
     bool network_broadcast_api::check_max_block_age( int32_t max_block_age )
@@ -150,19 +159,18 @@ namespace sigmaengine { namespace app {
        _max_block_age = max_block_age;
     }
 
-    void network_broadcast_api::on_applied_block( const signed_block& b )
+    void network_broadcast_api::on_applied_block( const applied_block_notice_ptr& notice )
     {
        /// we need to ensure the database_api is not deleted for the life of the async operation
        auto capture_this = shared_from_this();
 
-       fc::async( [this,capture_this,b]() {
-          int32_t block_num = int32_t(b.block_num());
+       fc::async( [this,capture_this,notice]() {
+          int32_t block_num = int32_t(notice->block_num);
           if( _callbacks.size() )
           {
-             for( size_t trx_num = 0; trx_num < b.transactions.size(); ++trx_num )
+             for( size_t trx_num = 0; trx_num < notice->transaction_ids.size(); ++trx_num )
              {
-                const auto& trx = b.transactions[trx_num];
-                auto id = trx.id();
+                const auto& id = notice->transaction_ids[trx_num];
                 auto itr = _callbacks.find(id);
                 if( itr == _callbacks.end() ) continue;
                 confirmation_callback callback = itr->second;
@@ -177,7 +185,7 @@ namespace sigmaengine { namespace app {
              auto exp_it = _callbacks_expirations.begin();
              if( exp_it == _callbacks_expirations.end() )
                 break;
-             if( exp_it->first >= b.timestamp )
+             if( exp_it->first >= notice->timestamp )
                 break;
              for( const transaction_id_type& txid : exp_it->second )
              {
@@ -194,6 +202,9 @@ namespace sigmaengine { namespace app {
              }
              _callbacks_expirations.erase( exp_it );
           }
+
+          if( _callbacks_expirations.empty() )
+             _applied_block_connection.disconnect();
        }); /// fc::async
 
     }
@@ -281,8 +292,10 @@ namespace sigmaengine { namespace app {
        {
           FC_ASSERT( !check_max_block_age( _max_block_age ) );
           trx.validate();
-          _callbacks[trx.id()] = cb;
-          _callbacks_expirations[trx.expiration].push_back(trx.id());
+          auto id = trx.id();
+          _callbacks[id] = cb;
+          _callbacks_expirations[trx.expiration].push_back(id);
+          subscribe_applied_block();
 
           _app.chain_database()->push_transaction(trx);
           _app.p2p_node()->broadcast_transaction(trx);
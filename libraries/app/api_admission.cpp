@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <sigmaengine/app/api_admission.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <algorithm>
+
+namespace sigmaengine { namespace app {
+
+namespace detail {
+
+   struct api_admission_counters
+   {
+      std::map< std::string, uint32_t > running_by_method;
+   };
+
+}
+
+bool resolve_call_method( const std::string& method, const fc::variants& params, std::string& result )
+{
+   if( method == "notice" || method == "callback" )
+      return false;
+
+   if( method == "call" )
+   {
+      if( params.size() < 2 || !params[1].is_string() )
+         return false;
+      result = params[1].get_string();
+      return true;
+   }
+
+   result = method;
+   return true;
+}
+
+void api_connection_budget::set_limits( const fc::optional< api_rate_limit >& l )
+{
+   limits = l;
+   method_limits.clear();
+
+   if( !limits.valid() )
+      return;
+
+   if( limits->burst == 0 )
+      limits->burst = limits->requests_per_second;
+
+   for( const api_method_limit& m : limits->methods )
+      method_limits[ m.method ] = m;
+
+   tokens = limits->burst;
+   last_refill = fc::time_point::now();
+}
+
+api_admission_controller::api_admission_controller()
+   : _counters( std::make_shared< detail::api_admission_counters >() ) {}
+
+std::shared_ptr< void > api_admission_controller::admit( const std::shared_ptr< api_connection_budget >& budget,
+                                                         const std::string& method, const fc::variants& params )
+{
+   std::string method_name;
+   if( !budget || !budget->limits.valid() || !resolve_call_method( method, params, method_name ) )
+      return std::shared_ptr< void >();
+
+   const api_rate_limit& limits = *budget->limits;
+
+   const api_method_limit* method_limit = nullptr;
+   auto mitr = budget->method_limits.find( method_name );
+   if( mitr != budget->method_limits.end() )
+      method_limit = &mitr->second;
+
+   FC_ASSERT( limits.max_queue_depth == 0 || budget->in_flight < limits.max_queue_depth,
+              "Too many pending API calls on this connection, limit: ${l}", ("l", limits.max_queue_depth) );
+
+   if( method_limit && method_limit->max_concurrent )
+   {
+      FC_ASSERT( _counters->running_by_method[ method_name ] < method_limit->max_concurrent,
+                 "API method ${m} is busy, try again later", ("m", method_name) );
+   }
+
+   if( limits.requests_per_second )
+   {
+      fc::time_point now = fc::time_point::now();
+      double elapsed = double( ( now - budget->last_refill ).count() ) / 1000000;
+      budget->tokens = std::min( double( limits.burst ), budget->tokens + elapsed * limits.requests_per_second );
+      budget->last_refill = now;
+
+      uint32_t cost = method_limit ? method_limit->cost : 1;
+      FC_ASSERT( budget->tokens >= cost, "API rate limit exceeded for method ${m}", ("m", method_name) );
+      budget->tokens -= cost;
+   }
+
+   ++budget->in_flight;
+   if( method_limit && method_limit->max_concurrent )
+      ++_counters->running_by_method[ method_name ];
+   else
+      method_name.clear();
+
+   auto counters = _counters;
+   return std::shared_ptr< void >( nullptr, [budget, counters, method_name]( void* )
+   {
+      --budget->in_flight;
+      if( method_name.size() )
+      {
+         auto itr = counters->running_by_method.find( method_name );
+         if( itr != counters->running_by_method.end() && --itr->second == 0 )
+            counters->running_by_method.erase( itr );
+      }
+   } );
+}
+
+} } // sigmaengine::app
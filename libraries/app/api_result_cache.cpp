@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <sigmaengine/app/api_result_cache.hpp>
+
+#include <fc/io/json.hpp>
+
+namespace sigmaengine { namespace app {
+
+/// irreversible entries are tagged with generation 0 and survive invalidation
+static const uint64_t irreversible_generation = 0;
+
+api_result_cache::api_result_cache( const std::set< std::string >& methods, uint32_t max_entries )
+   : _methods( methods ), _max_entries( max_entries ) {}
+
+bool api_result_cache::is_irreversible_call( const std::string& method, const fc::variants& args )const
+{
+   if( method != "get_block" && method != "get_ops_in_block" )
+      return false;
+   if( args.empty() || !args[0].is_numeric() )
+      return false;
+
+   uint64_t block_num = args[0].as_uint64();
+   return block_num > 0 && block_num <= _last_irreversible_block_num;
+}
+
+bool api_result_cache::lookup( const std::string& api, const std::string& method, const fc::variants& args, cached_call& call )
+{
+   if( _methods.find( method ) == _methods.end() )
+      return false;
+
+   call.key = api + ":" + method + fc::json::to_string( args );
+
+   std::lock_guard< std::mutex > lock( _mutex );
+   if( is_irreversible_call( method, args ) )
+   {
+      call.generation = irreversible_generation;
+      auto itr = _irreversible_entries.find( call.key );
+      if( itr != _irreversible_entries.end() )
+         call.result = itr->second;
+   }
+   else
+   {
+      call.generation = _generation;
+      auto itr = _block_entries.find( call.key );
+      if( itr != _block_entries.end() )
+         call.result = itr->second;
+   }
+
+   return true;
+}
+
+void api_result_cache::store( const cached_call& call, const std::string& result )
+{
+   std::lock_guard< std::mutex > lock( _mutex );
+
+   if( call.generation == irreversible_generation )
+   {
+      if( !_irreversible_entries.emplace( call.key, result ).second )
+         return;
+
+      _irreversible_order.push_back( call.key );
+      while( _irreversible_order.size() > _max_entries )
+      {
+         _irreversible_entries.erase( _irreversible_order.front() );
+         _irreversible_order.pop_front();
+      }
+   }
+   else if( call.generation == _generation && _block_entries.size() < _max_entries )
+   {
+      // a block applied while the call was running would have made the result stale
+      _block_entries.emplace( call.key, result );
+   }
+}
+
+void api_result_cache::on_applied_block( uint32_t last_irreversible_block_num )
+{
+   std::lock_guard< std::mutex > lock( _mutex );
+   ++_generation;
+   _last_irreversible_block_num = last_irreversible_block_num;
+   _block_entries.clear();
+}
+
+} } // sigmaengine::app
@@ -23,6 +23,7 @@
  */
 #include <sigmaengine/app/api.hpp>
 #include <sigmaengine/app/api_access.hpp>
+#include <sigmaengine/app/api_result_cache.hpp>
 #include <sigmaengine/app/application.hpp>
 #include <sigmaengine/app/plugin.hpp>
 
@@ -78,6 +79,14 @@ namespace bpo = boost::program_options;
 api_context::api_context( application& _app, const std::string& _api_name, std::weak_ptr< api_session_data > _session )
    : app(_app), api_name(_api_name), session(_session) {}
 
+applied_block_notice::applied_block_notice( const signed_block& b )
+   : block_num( b.block_num() ), timestamp( b.timestamp ), header( signed_block_header( b ) )
+{
+   transaction_ids.reserve( b.transactions.size() );
+   for( const auto& trx : b.transactions )
+      transaction_ids.push_back( trx.id() );
+}
+
 namespace detail {
 
    class application_impl : public graphene::net::node_delegate
@@ -218,6 +227,21 @@ namespace detail {
       {
          std::shared_ptr< api_session_data > session = std::make_shared<api_session_data>();
          session->wsc = std::make_shared<fc::rpc::websocket_api_connection>(*c);
+         session->budget = std::make_shared<api_connection_budget>();
+
+         // Anonymous connections are held to the limits of the wildcard api-user until they log in
+         auto anonymous = get_api_access_info( "*" );
+         if( anonymous.valid() )
+            session->budget->set_limits( anonymous->limits );
+
+         std::weak_ptr< api_connection_budget > weak_budget = session->budget;
+         session->wsc->set_admission_handler( [this,weak_budget]( const std::string& method, const fc::variants& params )
+         {
+            return _admission.admit( weak_budget.lock(), method, params );
+         } );
+
+         if( _result_cache )
+            session->wsc->set_result_cache( _result_cache );
 
          for( const std::string& name : _public_apis )
          {
@@ -286,6 +310,16 @@ namespace detail {
 
             _chain_db->set_flush_interval( _options->at("flush").as<uint32_t>() );
 
+            std::string block_log_sync = _options->at("block-log-sync").as< std::string >();
+            chain::block_log::sync_policy sync_policy = chain::block_log::sync_flush;
+            if( block_log_sync == "none" )
+               sync_policy = chain::block_log::sync_none;
+            else if( block_log_sync == "batch" )
+               sync_policy = chain::block_log::sync_batch;
+            else
+               FC_ASSERT( block_log_sync == "flush", "Unknown block-log-sync policy ${p}", ("p", block_log_sync) );
+            _chain_db->set_block_log_write_policy( _options->at("block-log-max-unsynced").as< uint32_t >(), sync_policy );
+
             flat_map<uint32_t,block_id_type> loaded_checkpoints;
             if( _options->count("checkpoint") )
             {
@@ -361,6 +395,12 @@ ilog( "_options->count(black-list) : ${ccc}", ("ccc", _options->count("black-lis
          }
          _chain_db->show_free_memory( true );
 
+         _chain_db->applied_block.connect( [this]( const signed_block& b )
+         {
+            if( !_self->applied_block_notice.empty() )
+               _self->applied_block_notice( std::make_shared< applied_block_notice >( b ) );
+         } );
+
          if( _options->count("api-user") )
          {
             for( const std::string& api_access_str : _options->at("api-user").as< std::vector<std::string> >() )
@@ -384,6 +424,30 @@ ilog( "_options->count(black-list) : ${ccc}", ("ccc", _options->count("black-lis
             _apiaccess.permission_map["*"] = wild_access;
          }
 
+         // Read-only nodes never see applied_block, so they would have nothing to invalidate the cache with
+         uint32_t api_cache_size = _options->at( "api-cache-size" ).as< uint32_t >();
+         if( !read_only && api_cache_size )
+         {
+            std::set< std::string > cached_methods;
+            for( const std::string& arg : _options->at( "api-cache-method" ).as< std::vector< std::string > >() )
+            {
+               vector<string> names;
+               boost::split(names, arg, boost::is_any_of(" \t,"));
+               for( const std::string& name : names )
+               {
+                  if( name.size() )
+                     cached_methods.insert( name );
+               }
+            }
+
+            _result_cache = std::make_shared< api_result_cache >( cached_methods, api_cache_size );
+            _chain_db->applied_block.connect( [this]( const signed_block& b )
+            {
+               _result_cache->on_applied_block( _chain_db->last_non_undoable_block_num() );
+            } );
+            ilog( "API result cache enabled for ${m}", ("m", cached_methods) );
+         }
+
          for( const std::string& arg : _options->at("public-api").as< std::vector< std::string > >() )
          {
             vector<string> names;
@@ -511,7 +575,8 @@ ilog( "_options->count(black-list) : ${ccc}", ("ccc", _options->count("black-lis
                // you can help the network code out by throwing a block_older_than_undo_history exception.
                // when the net code sees that, it will stop trying to push blocks from that chain, but
                // leave that peer connected so that they can get sync blocks from us
-               bool result = _chain_db->push_block(blk_msg.block, (_is_block_producer | _force_validate) ? database::skip_nothing : database::skip_transaction_signatures);
+               bool result = _chain_db->push_block(blk_msg.block, (_is_block_producer | _force_validate) ? database::skip_nothing : database::skip_transaction_signatures,
+                                                   blk_msg.packed_block);
 
                if( !sync_mode )
                {
@@ -921,6 +986,8 @@ ilog( "_options->count(black-list) : ${ccc}", ("ccc", _options->count("black-lis
       fc::path _shared_dir;
       const bpo::variables_map* _options = nullptr;
       api_access _apiaccess;
+      api_admission_controller _admission;
+      std::shared_ptr< api_result_cache > _result_cache;
 
       //std::shared_ptr<graphene::db::object_database>   _pending_trx_db;
       std::shared_ptr<sigmaengine::chain::database>        _chain_db;
@@ -985,6 +1052,15 @@ void application::set_program_options(boost::program_options::options_descriptio
    default_plugins.push_back( "dapp_history" );
    std::string str_default_plugins = boost::algorithm::join( default_plugins, " " );
 
+   std::vector< std::string > default_cached_methods;
+   default_cached_methods.push_back( "get_dynamic_global_properties" );
+   default_cached_methods.push_back( "get_config" );
+   default_cached_methods.push_back( "get_active_bobservers" );
+   default_cached_methods.push_back( "lookup_bproducer_accounts" );
+   default_cached_methods.push_back( "get_block" );
+   default_cached_methods.push_back( "get_ops_in_block" );
+   std::string str_default_cached_methods = boost::algorithm::join( default_cached_methods, " " );
+
    configuration_file_options.add_options()
          ("p2p-endpoint", bpo::value<string>(), "Endpoint for P2P node to listen on")
          ("p2p-max-connections", bpo::value<uint32_t>(), "Maxmimum number of incoming connections on P2P endpoint")
@@ -998,10 +1074,14 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("server-pem,p", bpo::value<string>()->implicit_value("server.pem"), "The TLS certificate file for this server")
          ("server-pem-password,P", bpo::value<string>()->implicit_value(""), "Password for this certificate")
          ("api-user", bpo::value< vector<string> >()->composing(), "API user specification, may be specified multiple times")
+         ("api-cache-method", bpo::value< vector<string> >()->composing()->default_value(default_cached_methods, str_default_cached_methods), "Read-only API method whose results are cached until the next block, may be specified multiple times")
+         ("api-cache-size", bpo::value< uint32_t >()->default_value(1000), "Maximum number of cached API results, 0 disables the cache")
          ("public-api", bpo::value< vector<string> >()->composing()->default_value(default_apis, str_default_apis), "Set an API to be publicly available, may be specified multiple times")
          ("enable-plugin", bpo::value< vector<string> >()->composing()->default_value(default_plugins, str_default_plugins), "Plugin(s) to enable, may be specified multiple times")
          ("max-block-age", bpo::value< int32_t >()->default_value(200), "Maximum age of head block when broadcasting tx via API")
          ("flush", bpo::value< uint32_t >()->default_value(100000), "Flush shared memory file to disk this many blocks")
+         ("block-log-max-unsynced", bpo::value< uint32_t >()->default_value(1024), "With block-log-sync=batch, maximum number of blocks written to the block log but not yet synced to disk")
+         ("block-log-sync", bpo::value< std::string >()->default_value("flush"), "When to fsync the block log: none, flush (with the shared memory file and on close) or batch (by a background thread, after each group of appended blocks)")
          ("backtrace", bpo::value<string>()->default_value("yes"), "Whether to print backtrace on SIGSEGV")
          ("black-list", bpo::value<vector<string>>()->composing(), "black-list account")
          ;
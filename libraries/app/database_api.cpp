@@ -72,10 +72,11 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       bool verify_account_authority( const string& name_or_id, const flat_set<public_key_type>& signers )const;
 
       // signal handlers
-      void on_applied_block( const chain::signed_block& b );
+      void on_applied_block( const applied_block_notice_ptr& notice );
 
       std::function<void(const fc::variant&)> _block_applied_callback;
 
+      sigmaengine::app::application&               _app;
       sigmaengine::chain::database&                _db;
 
       boost::signals2::scoped_connection       _block_applied_connection;
@@ -111,11 +112,11 @@ void database_api::set_block_applied_callback( std::function<void(const variant&
    });
 }
 
-void database_api_impl::on_applied_block( const chain::signed_block& b )
+void database_api_impl::on_applied_block( const applied_block_notice_ptr& notice )
 {
    try
    {
-      _block_applied_callback( fc::variant(signed_block_header(b) ) );
+      _block_applied_callback( notice->header );
    }
    catch( ... )
    {
@@ -126,7 +127,7 @@ void database_api_impl::on_applied_block( const chain::signed_block& b )
 void database_api_impl::set_block_applied_callback( std::function<void(const variant& block_header)> cb )
 {
    _block_applied_callback = cb;
-   _block_applied_connection = connect_signal( _db.applied_block, *this, &database_api_impl::on_applied_block );
+   _block_applied_connection = connect_signal( _app.applied_block_notice, *this, &database_api_impl::on_applied_block );
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -141,7 +142,7 @@ database_api::database_api( const sigmaengine::app::api_context& ctx )
 database_api::~database_api() {}
 
 database_api_impl::database_api_impl( const sigmaengine::app::api_context& ctx )
-   : _db( *ctx.app.chain_database() )
+   : _app( ctx.app ), _db( *ctx.app.chain_database() )
 {
    wlog("creating database api ${x}", ("x",int64_t(this)) );
 
@@ -281,6 +282,14 @@ scheduled_hardfork database_api::get_next_scheduled_hardfork() const
    });
 }
 
+fork_database_metrics database_api::get_fork_db_metrics()const
+{
+   return my->_db.with_read_lock( [&]()
+   {
+      return my->_db.get_fork_db_metrics();
+   });
+}
+
 common_fund_api_obj database_api::get_common_fund( string name )const
 {
    return my->_db.with_read_lock( [&]()
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <sigmaengine/app/api_context.hpp>
+#include <sigmaengine/app/applied_block_notice.hpp>
 #include <sigmaengine/app/database_api.hpp>
 #include <sigmaengine/protocol/types.hpp>
 
@@ -100,17 +101,19 @@ namespace sigmaengine { namespace app {
          /**
           * @brief Not reflected, thus not accessible to API clients.
           *
-          * This function is registered to receive the applied_block
-          * signal from the chain database when a block is received.
+          * This function is registered to receive the applied_block_notice
+          * signal from the application while confirmations are pending.
           * It then dispatches callbacks to clients who have requested
           * to be notified when a particular txid is included in a block.
           */
-         void on_applied_block( const signed_block& b );
+         void on_applied_block( const applied_block_notice_ptr& notice );
 
          /// internal method, not exposed via JSON RPC
          void on_api_startup();
 
       private:
+         void subscribe_applied_block();
+
          boost::signals2::scoped_connection             _applied_block_connection;
 
          map<transaction_id_type,confirmation_callback>     _callbacks;
@@ -23,6 +23,7 @@
  */
 #pragma once
 
+#include <fc/optional.hpp>
 #include <fc/reflect/reflect.hpp>
 
 #include <map>
@@ -31,12 +32,28 @@
 
 namespace sigmaengine { namespace app {
 
+struct api_method_limit
+{
+   std::string method;
+   uint32_t    cost = 1;                   ///< tokens charged against the connection budget per call
+   uint32_t    max_concurrent = 0;         ///< calls of this method running node-wide, 0 for no cap
+};
+
+struct api_rate_limit
+{
+   uint32_t    requests_per_second = 0;    ///< budget refill rate per connection, 0 disables rate limiting
+   uint32_t    burst = 0;                  ///< budget capacity, defaults to requests_per_second
+   uint32_t    max_queue_depth = 0;        ///< calls in flight per connection, 0 for no cap
+   std::vector< api_method_limit > methods;
+};
+
 struct api_access_info
 {
    std::string username;
    std::string password_hash_b64;
    std::string password_salt_b64;
    std::vector< std::string > allowed_apis;
+   fc::optional< api_rate_limit > limits;
 };
 
 struct api_access
@@ -46,11 +63,25 @@ struct api_access
 
 } } // sigmaengine::app
 
+FC_REFLECT( sigmaengine::app::api_method_limit,
+    (method)
+    (cost)
+    (max_concurrent)
+   )
+
+FC_REFLECT( sigmaengine::app::api_rate_limit,
+    (requests_per_second)
+    (burst)
+    (max_queue_depth)
+    (methods)
+   )
+
 FC_REFLECT( sigmaengine::app::api_access_info,
     (username)
     (password_hash_b64)
     (password_salt_b64)
     (allowed_apis)
+    (limits)
    )
 
 FC_REFLECT( sigmaengine::app::api_access,
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <sigmaengine/app/api_access.hpp>
+
+#include <fc/time.hpp>
+#include <fc/variant.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+
+namespace sigmaengine { namespace app {
+
+namespace detail { struct api_admission_counters; }
+
+/**
+ * Extracts the API method name from an incoming websocket request.  Calls arrive either as
+ * "call" with ["api", "method", [args]] or directly by method name.  Returns false for replies
+ * to our own callbacks and for malformed calls.
+ */
+bool resolve_call_method( const std::string& method, const fc::variants& params, std::string& result );
+
+/**
+ * Per connection admission state.  Holds the request budget and in flight count of a single
+ * websocket session, along with the limits of the api-user it is currently logged in as.
+ */
+class api_connection_budget
+{
+   public:
+      void set_limits( const fc::optional< api_rate_limit >& limits );
+
+      fc::optional< api_rate_limit >            limits;
+      std::map< std::string, api_method_limit > method_limits;
+
+      double                                    tokens = 0;
+      fc::time_point                            last_refill;
+      uint32_t                                  in_flight = 0;
+};
+
+/**
+ * Admission control for the websocket API.  Every incoming call is charged against the budget of
+ * its connection, checked against the per method concurrency caps and the connection queue depth,
+ * and rejected immediately when any of them is exhausted.
+ */
+class api_admission_controller
+{
+   public:
+      api_admission_controller();
+
+      /**
+       * Admits a call on the given connection, or throws if it must be rejected.  The returned token
+       * releases the call's concurrency slots when destroyed.
+       */
+      std::shared_ptr< void > admit( const std::shared_ptr< api_connection_budget >& budget,
+                                     const std::string& method, const fc::variants& params );
+
+   private:
+      std::shared_ptr< detail::api_admission_counters > _counters;
+};
+
+} } // sigmaengine::app
@@ -4,6 +4,8 @@
 #include <string>
 #include <utility>
 
+#include <sigmaengine/app/api_admission.hpp>
+
 #include <fc/api.hpp>
 
 namespace fc { namespace rpc {
@@ -25,6 +27,7 @@ struct api_session_data
 {
    std::shared_ptr< fc::rpc::websocket_api_connection >        wsc;
    std::map< std::string, fc::api_ptr >                        api_map;
+   std::shared_ptr< api_connection_budget >                    budget;
 };
 
 /**
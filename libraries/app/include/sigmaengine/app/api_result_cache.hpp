@@ -0,0 +1,45 @@
+#pragma once
+
+#include <fc/rpc/websocket_api.hpp>
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace sigmaengine { namespace app {
+
+/**
+ * Node-wide cache of serialized results for hot read-only API calls, keyed by api, method and arguments.
+ *
+ * Entries are dropped whenever a block is applied, except for get_block and get_ops_in_block on
+ * irreversible blocks, which never change and are kept until evicted by size.  A hit is answered
+ * straight from the cache without taking the database read lock.
+ */
+class api_result_cache : public fc::rpc::result_cache
+{
+   public:
+      api_result_cache( const std::set< std::string >& methods, uint32_t max_entries );
+
+      virtual bool lookup( const std::string& api, const std::string& method, const fc::variants& args, cached_call& call ) override;
+      virtual void store( const cached_call& call, const std::string& result ) override;
+
+      /// Invalidates per-block entries, called from the applied_block signal
+      void on_applied_block( uint32_t last_irreversible_block_num );
+
+   private:
+      bool is_irreversible_call( const std::string& method, const fc::variants& args )const;
+
+      std::set< std::string >                 _methods;
+      uint32_t                                _max_entries;
+
+      std::mutex                              _mutex;
+      uint64_t                                _generation = 1;
+      uint32_t                                _last_irreversible_block_num = 0;
+      std::map< std::string, std::string >    _block_entries;
+      std::map< std::string, std::string >    _irreversible_entries;
+      std::deque< std::string >               _irreversible_order;
+};
+
+} } // sigmaengine::app
@@ -25,6 +25,7 @@
 
 #include <sigmaengine/app/api_access.hpp>
 #include <sigmaengine/app/api_context.hpp>
+#include <sigmaengine/app/applied_block_notice.hpp>
 #include <sigmaengine/chain/database.hpp>
 
 #include <graphene/net/node.hpp>
@@ -121,6 +122,12 @@ namespace sigmaengine { namespace app {
 
          void connect_to_write_node();
 
+         /**
+          * Emitted once per applied block with a notice shared by all subscribed API sessions.
+          * The notice is only built while at least one session is connected.
+          */
+         fc::signal< void( const applied_block_notice_ptr& ) > applied_block_notice;
+
          bool _read_only = true;
          bool _disable_get_block = false;
          fc::optional< string > _remote_endpoint;
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <sigmaengine/protocol/block.hpp>
+
+#include <fc/variant.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace sigmaengine { namespace app {
+
+/**
+ * Everything API sessions need to know about an applied block, computed once per block by the
+ * application and shared by all subscribed sessions instead of each of them copying the block.
+ */
+struct applied_block_notice
+{
+   applied_block_notice( const sigmaengine::protocol::signed_block& b );
+
+   uint32_t                                                  block_num = 0;
+   fc::time_point_sec                                        timestamp;
+   std::vector< sigmaengine::protocol::transaction_id_type > transaction_ids;
+   fc::variant                                               header;
+};
+
+typedef std::shared_ptr< const applied_block_notice > applied_block_notice_ptr;
+
+} } // sigmaengine::app
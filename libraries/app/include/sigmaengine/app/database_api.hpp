@@ -107,6 +107,11 @@ class database_api
       hardfork_version                 get_hardfork_version()const;
       scheduled_hardfork               get_next_scheduled_hardfork()const;
 
+      /**
+       * @brief Retrieve the size of the fork database and the depth of the forks it has seen
+       */
+      fork_database_metrics            get_fork_db_metrics()const;
+
       common_fund_api_obj              get_common_fund( string name )const;
       variant                          get_fund_info(string name) const;
 
@@ -300,6 +305,7 @@ FC_API(sigmaengine::app::database_api,
    (get_bobserver_schedule)
    (get_hardfork_version)
    (get_next_scheduled_hardfork)
+   (get_fork_db_metrics)
 
    (get_dapp_reward_fund)
 
@@ -2,6 +2,15 @@
 #include <fstream>
 #include <fc/io/raw.hpp>
 
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
 #define LOG_READ  (std::ios::in | std::ios::binary)
 #define LOG_WRITE (std::ios::out | std::ios::binary | std::ios::app)
 
@@ -10,6 +19,8 @@ namespace sigmaengine { namespace chain {
    namespace detail {
       class block_log_impl {
          public:
+            ~block_log_impl() { close_files(); }
+
             optional< signed_block > head;
             block_id_type            head_id;
             std::fstream             block_stream;
@@ -19,6 +30,27 @@ namespace sigmaengine { namespace chain {
             bool                     block_write = false;
             bool                     index_write = false;
 
+            /// state shared with the sync thread, guarded by sync_mutex
+            std::mutex                                     sync_mutex;
+            std::condition_variable                        sync_cond;
+            uint32_t                                       max_unsynced_blocks = 1024;
+            block_log::sync_policy                         policy = block_log::sync_flush;
+            uint64_t                                       written = 0;    ///< blocks appended since open
+            uint64_t                                       synced = 0;     ///< blocks appended since open and known to be on disk
+            bool                                           stopping = false;
+            optional< std::string >                        error;          ///< set once a write or sync failed, appends are refused from then on
+            std::thread                                    syncer;
+
+            int                                            block_fd = -1;
+            int                                            index_fd = -1;
+            uint64_t                                       end_pos = 0;    ///< end of the main file
+
+            void open_files( uint32_t max_unsynced, block_log::sync_policy sync );
+            void close_files();
+            void sync_loop();
+            void sync_files();
+            void recover();
+
             inline void check_block_read()
             {
                try
@@ -81,6 +113,191 @@ namespace sigmaengine { namespace chain {
                FC_LOG_AND_RETHROW()
             }
       };
+
+      static void write_all( int fd, const std::vector< char >& data )
+      {
+         size_t written = 0;
+         while( written < data.size() )
+         {
+            auto result = ::write( fd, data.data() + written, data.size() - written );
+            if( result < 0 )
+            {
+               FC_ASSERT( errno == EINTR, "Unable to write to the block log: ${e}", ("e", strerror( errno )) );
+               continue;
+            }
+            written += result;
+         }
+      }
+
+      static void sync_file( int fd )
+      {
+#ifdef __linux__
+         FC_ASSERT( ::fdatasync( fd ) == 0, "Unable to sync the block log: ${e}", ("e", strerror( errno )) );
+#else
+         FC_ASSERT( ::fsync( fd ) == 0, "Unable to sync the block log: ${e}", ("e", strerror( errno )) );
+#endif
+      }
+
+      void block_log_impl::open_files( uint32_t max_unsynced, block_log::sync_policy sync )
+      {
+         max_unsynced_blocks = std::max< uint32_t >( max_unsynced, 1 );
+         policy = sync;
+
+         block_fd = ::open( block_file.generic_string().c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644 );
+         FC_ASSERT( block_fd >= 0, "Unable to open ${f}: ${e}", ("f", block_file)("e", strerror( errno )) );
+         index_fd = ::open( index_file.generic_string().c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644 );
+         FC_ASSERT( index_fd >= 0, "Unable to open ${f}: ${e}", ("f", index_file)("e", strerror( errno )) );
+         end_pos = fc::file_size( block_file );
+
+         written = synced = 0;
+         stopping = false;
+         error.reset();
+         if( policy == block_log::sync_batch )
+            syncer = std::thread( [this](){ sync_loop(); } );
+      }
+
+      void block_log_impl::close_files()
+      {
+         if( syncer.joinable() )
+         {
+            {
+               std::lock_guard< std::mutex > lock( sync_mutex );
+               stopping = true;
+            }
+            sync_cond.notify_all();
+            syncer.join();
+         }
+
+         if( block_fd >= 0 )
+            ::close( block_fd );
+         if( index_fd >= 0 )
+            ::close( index_fd );
+         block_fd = index_fd = -1;
+      }
+
+      /**
+       * Syncs the files whenever blocks were appended since the last sync, so a burst of
+       * irreversible blocks shares one sync.  The blocks are already in the files when they are
+       * appended, only getting them to disk is left to this thread.
+       */
+      void block_log_impl::sync_loop()
+      {
+         std::unique_lock< std::mutex > lock( sync_mutex );
+         while( true )
+         {
+            sync_cond.wait( lock, [&](){ return stopping || written > synced; } );
+            if( written == synced )
+               return;
+
+            uint64_t target = written;
+            lock.unlock();
+
+            optional< std::string > sync_error;
+            try
+            {
+               sync_files();
+            }
+            catch( const fc::exception& e )
+            {
+               sync_error = e.to_detail_string();
+            }
+            catch( const std::exception& e )
+            {
+               sync_error = std::string( e.what() );
+            }
+            catch( ... )
+            {
+               sync_error = std::string( "unknown exception" );
+            }
+
+            lock.lock();
+            if( sync_error )
+            {
+               elog( "Error syncing the block log: ${e}", ("e", *sync_error) );
+               if( !error )
+                  error = sync_error;
+            }
+            synced = target;
+            sync_cond.notify_all();
+         }
+      }
+
+      /// the main file is synced first, the index can always be rebuilt from it
+      void block_log_impl::sync_files()
+      {
+         sync_file( block_fd );
+         sync_file( index_fd );
+      }
+
+      /**
+       * Finds the end of the last complete block and cuts off anything after it.  The last index
+       * entry that points to a complete block is where the scan starts, so only the blocks written
+       * after it are read.
+       */
+      void block_log_impl::recover()
+      {
+         auto log_size = fc::file_size( block_file );
+         if( !log_size )
+            return;
+
+         std::ifstream in( block_file.generic_string().c_str(), LOG_READ );
+         in.exceptions( std::ifstream::failbit | std::ifstream::badbit );
+
+         auto block_end = [&]( uint64_t pos ) -> uint64_t
+         {
+            try
+            {
+               signed_block tmp;
+               in.clear();
+               in.seekg( pos );
+               fc::raw::unpack( in, tmp );
+               uint64_t end = uint64_t( in.tellg() ) + sizeof( uint64_t );
+               if( end > log_size )
+                  return 0;
+               uint64_t trailing_pos;
+               in.read( (char*)&trailing_pos, sizeof( trailing_pos ) );
+               return trailing_pos == pos ? end : 0;
+            }
+            catch( ... )
+            {
+               return 0;
+            }
+         };
+
+         uint64_t tail_pos;
+         in.seekg( log_size - std::min< uint64_t >( log_size, sizeof( tail_pos ) ) );
+         if( log_size >= sizeof( tail_pos ) )
+         {
+            in.read( (char*)&tail_pos, sizeof( tail_pos ) );
+            if( tail_pos < log_size && block_end( tail_pos ) == log_size )
+               return;
+         }
+
+         uint64_t scan_pos = 0;
+         {
+            std::ifstream index( index_file.generic_string().c_str(), LOG_READ );
+            uint64_t entries = fc::exists( index_file ) ? fc::file_size( index_file ) / sizeof( uint64_t ) : 0;
+            for( ; entries > 0 && index; --entries )
+            {
+               uint64_t pos;
+               index.seekg( ( entries - 1 ) * sizeof( pos ) );
+               index.read( (char*)&pos, sizeof( pos ) );
+               if( index && pos < log_size && block_end( pos ) )
+               {
+                  scan_pos = pos;
+                  break;
+               }
+            }
+         }
+
+         uint64_t good_end = 0;
+         for( uint64_t end = block_end( scan_pos ); end; end = block_end( end ) )
+            good_end = end;
+
+         wlog( "Block log ends with an incomplete block, truncating it from ${s} to ${e} bytes", ("s", log_size)("e", good_end) );
+         in.close();
+         fc::resize_file( block_file, good_end );
+      }
    }
 
    block_log::block_log()
@@ -92,11 +309,25 @@ namespace sigmaengine { namespace chain {
 
    block_log::~block_log()
    {
-      flush();
+      try
+      {
+         flush();
+      }
+      catch( const fc::exception& e )
+      {
+         elog( "Error closing the block log: ${e}", ("e", e.to_detail_string()) );
+      }
+   }
+
+   void block_log::set_write_policy( uint32_t max_unsynced_blocks, sync_policy policy )
+   {
+      _max_unsynced_blocks = max_unsynced_blocks;
+      _sync_policy = policy;
    }
 
    void block_log::open( const fc::path& file )
    {
+      my->close_files();
       if( my->block_stream.is_open() )
          my->block_stream.close();
       if( my->index_stream.is_open() )
@@ -105,6 +336,9 @@ namespace sigmaengine { namespace chain {
       my->block_file = file;
       my->index_file = fc::path( file.generic_string() + ".index" );
 
+      if( fc::exists( my->block_file ) )
+         my->recover();
+
       my->block_stream.open( my->block_file.generic_string().c_str(), LOG_WRITE );
       my->index_stream.open( my->index_file.generic_string().c_str(), LOG_WRITE );
       my->block_write = true;
@@ -151,7 +385,12 @@ namespace sigmaengine { namespace chain {
             my->index_stream.seekg( -sizeof( uint64_t), std::ios::end );
             my->index_stream.read( (char*)&index_pos, sizeof( index_pos ) );
 
-            if( block_pos < index_pos )
+            if( index_size % sizeof( uint64_t ) )
+            {
+               ilog( "Index ends with an incomplete entry" );
+               construct_index();
+            }
+            else if( block_pos < index_pos )
             {
                ilog( "block_pos < index_pos, close and reopen index_stream" );
                construct_index();
@@ -176,10 +415,16 @@ namespace sigmaengine { namespace chain {
          my->index_stream.open( my->index_file.generic_string().c_str(), LOG_WRITE );
          my->index_write = true;
       }
+
+      // appends are written through the file descriptors, the streams are only read from here on
+      my->check_block_read();
+      my->check_index_read();
+      my->open_files( _max_unsynced_blocks, _sync_policy );
    }
 
    void block_log::close()
    {
+      flush();
       my.reset( new detail::block_log_impl() );
    }
 
@@ -192,16 +437,47 @@ namespace sigmaengine { namespace chain {
    {
       try
       {
-         my->check_block_write();
-         my->check_index_write();
+         FC_ASSERT( my->block_fd >= 0, "Block log is not open" );
 
-         uint64_t pos = my->block_stream.tellp();
-         uint64_t index_pos = my->index_stream.tellp();
-         FC_ASSERT( index_pos == sizeof( uint64_t ) * uint64_t( b.block_num() - 1 ), "Append to index file occuring at wrong position.", ( "position", (uint64_t) my->index_stream.tellp() )( "expected",( b.block_num() - 1 ) * sizeof( uint64_t ) ) );
+         uint32_t expected = my->head ? my->head->block_num() + 1 : 1;
+         FC_ASSERT( b.block_num() == expected, "Append to block log occuring at wrong position.", ( "block_num", b.block_num() )( "expected", expected ) );
+
+         {
+            // only the batch policy leaves syncing to the sync thread, which bounds the blocks not yet on disk
+            std::unique_lock< std::mutex > lock( my->sync_mutex );
+            my->sync_cond.wait( lock, [&](){ return my->error || my->written - my->synced < my->max_unsynced_blocks; } );
+            FC_ASSERT( !my->error, "Writing to the block log failed: ${e}", ("e", *my->error) );
+         }
+
+         uint64_t pos = my->end_pos;
          auto data = fc::raw::pack( b );
-         my->block_stream.write( data.data(), data.size() );
-         my->block_stream.write( (char*)&pos, sizeof( pos ) );
-         my->index_stream.write( (char*)&pos, sizeof( pos ) );
+         data.insert( data.end(), (const char*)&pos, (const char*)&pos + sizeof( pos ) );
+         std::vector< char > index_entry( (const char*)&pos, (const char*)&pos + sizeof( pos ) );
+
+         // written before returning, so the block is in the file by the time the block becomes irreversible
+         // in the shared memory file, and the main file first, the index can always be rebuilt from it
+         try
+         {
+            detail::write_all( my->block_fd, data );
+            detail::write_all( my->index_fd, index_entry );
+         }
+         catch( const fc::exception& e )
+         {
+            // the end of the file is unknown now, open cuts off the partly written block
+            std::lock_guard< std::mutex > lock( my->sync_mutex );
+            my->error = e.to_detail_string();
+            throw;
+         }
+         my->end_pos += data.size();
+
+         {
+            std::lock_guard< std::mutex > lock( my->sync_mutex );
+            ++my->written;
+            if( _sync_policy != sync_batch )
+               my->synced = my->written;
+         }
+         my->sync_cond.notify_all();
+
          my->head = b;
          my->head_id = b.id();
 
@@ -212,8 +488,20 @@ namespace sigmaengine { namespace chain {
 
    void block_log::flush()
    {
-      my->block_stream.flush();
-      my->index_stream.flush();
+      if( my->block_fd < 0 )
+         return;
+
+      std::unique_lock< std::mutex > lock( my->sync_mutex );
+      FC_ASSERT( !my->error, "Writing to the block log failed: ${e}", ("e", *my->error) );
+      if( _sync_policy == sync_none )
+         return;
+
+      uint64_t target = my->written;
+      lock.unlock();
+      my->sync_files();
+      lock.lock();
+      my->synced = std::max( my->synced, target );
+      my->sync_cond.notify_all();
    }
 
    std::pair< signed_block, uint64_t > block_log::read_block( uint64_t pos )const
@@ -255,6 +543,7 @@ namespace sigmaengine { namespace chain {
 
          if( !( my->head.valid() && block_num <= protocol::block_header::num_from_id( my->head_id ) && block_num > 0 ) )
             return npos;
+
          my->index_stream.seekg( sizeof( uint64_t ) * ( block_num - 1 ) );
          uint64_t pos;
          my->index_stream.read( (char*)&pos, sizeof( pos ) );
@@ -267,6 +556,9 @@ namespace sigmaengine { namespace chain {
    {
       try
       {
+         if( my->head && my->block_fd >= 0 )
+            return *my->head;
+
          my->check_block_read();
 
          uint64_t pos;
@@ -24,6 +24,7 @@
 
 #include <fc/smart_ref_impl.hpp>
 #include <fc/uint128.hpp>
+#include <fc/scoped_exit.hpp>
 
 #include <fc/container/deque.hpp>
 
@@ -217,6 +218,7 @@ void database::close(bool rewind)
       // DB state (issue #336).
       clear_pending();
 
+      _block_log.flush();
       chainbase::database::flush();
       chainbase::database::close();
 
@@ -283,6 +285,11 @@ block_id_type database::get_block_id_for_num( uint32_t block_num )const
 }
 
 
+fork_database_metrics database::get_fork_db_metrics()const
+{
+   return _fork_db.get_metrics();
+}
+
 optional<signed_block> database::fetch_block_by_id( const block_id_type& id )const
 { try {
    auto b = _fork_db.fetch_block( id );
@@ -297,7 +304,7 @@ optional<signed_block> database::fetch_block_by_id( const block_id_type& id )con
       return tmp;
    }
 
-   return b->data;
+   return b->block();
 } FC_CAPTURE_AND_RETHROW() }
 
 optional<signed_block> database::fetch_block_by_number( uint32_t block_num )const
@@ -306,7 +313,7 @@ optional<signed_block> database::fetch_block_by_number( uint32_t block_num )cons
 
    auto results = _fork_db.fetch_block_by_number( block_num );
    if( results.size() == 1 )
-      b = results[0]->data;
+      b = results[0]->block();
    else
       b = _block_log.read_block_by_num( block_num );
 
@@ -440,7 +447,7 @@ bool database::before_last_checkpoint()const
  *
  * @return true if we switched forks as a result of this push.
  */
-bool database::push_block(const signed_block& new_block, uint32_t skip)
+bool database::push_block(const signed_block& new_block, uint32_t skip, std::shared_ptr< const vector< char > > packed_block)
 {
    //fc::time_point begin_time = fc::time_point::now();
 
@@ -449,14 +456,17 @@ bool database::push_block(const signed_block& new_block, uint32_t skip)
    {
       with_write_lock( [&]()
       {
-         detail::without_pending_transactions( *this, std::move(_pending_tx), [&]()
+         detail::without_pending_transactions( *this, _pending_tx.take(), [&]()
          {
             try
             {
-               result = _push_block(new_block);
+               result = _push_block(new_block, std::move(packed_block));
             }
             FC_CAPTURE_AND_RETHROW( (new_block) )
          });
+
+         // keys of transactions the block included, or that no longer apply, are not needed anymore
+         _pending_tx.prune_signature_keys();
       });
    });
 
@@ -475,7 +485,8 @@ void database::_maybe_warn_multiple_production( uint32_t height )const
       vector< std::pair< account_name_type, fc::time_point_sec > > bobserver_time_pairs;
       for( const auto& b : blocks )
       {
-         bobserver_time_pairs.push_back( std::make_pair( b->data.bobserver, b->data.timestamp ) );
+         auto block = b->data();
+         bobserver_time_pairs.push_back( std::make_pair( block->bobserver, block->timestamp ) );
       }
 
       ilog( "Encountered block num collision at block ${n} due to a fork, bobservers are: ${w}", ("n", height)("w", bobserver_time_pairs) );
@@ -483,29 +494,52 @@ void database::_maybe_warn_multiple_production( uint32_t height )const
    return;
 }
 
-bool database::_push_block(const signed_block& new_block)
+bool database::_push_block(const signed_block& new_block, std::shared_ptr< const vector< char > > packed_block)
 { try {
    uint32_t skip = get_node_properties().skip_flags;
    //uint32_t skip_undo_db = skip & skip_undo_block;
 
+   shared_ptr<fork_item> new_head;
    if( !(skip&skip_fork_db) )
    {
-      shared_ptr<fork_item> new_head = _fork_db.push_block(new_block);
+      new_head = _fork_db.push_block(new_block, std::move(packed_block));
       _maybe_warn_multiple_production( new_head->num );
 
       //If the head block from the longest chain does not build off of the current head, we need to switch forks.
-      if( new_head->data.previous != head_block_id() )
+      if( new_head->previous != head_block_id() )
       {
          //If the newly pushed block is the same height as head, we get head back in new_head
          //Only switch forks if new_head is actually higher than head
-         if( new_head->data.block_num() > head_block_num() )
+         if( new_head->num > head_block_num() )
          {
             // wlog( "Switching to fork: ${id}", ("id",new_head->data.id()) );
-            auto branches = _fork_db.fetch_branch_from(new_head->data.id(), head_block_id());
+            auto branches = _fork_db.fetch_branch_from(new_head->id, head_block_id());
+
+            // reject what can be found invalid without state before unwinding our own head
+            for( auto ritr = branches.first.rbegin(); ritr != branches.first.rend(); ++ritr )
+            {
+               optional<fc::exception> except;
+               try
+               {
+                  prevalidate_fork_item( **ritr, skip );
+               }
+               catch ( const fc::exception& e ) { except = e; }
+               if( except )
+               {
+                  while( ritr != branches.first.rend() )
+                  {
+                     _fork_db.remove( (*ritr)->id );
+                     ++ritr;
+                  }
+                  _fork_db.set_head( branches.second.front() );
+                  throw *except;
+               }
+            }
 
             // pop blocks until we hit the forked block
-            while( head_block_id() != branches.second.back()->data.previous )
+            while( head_block_id() != branches.second.back()->previous )
                pop_block();
+            _fork_db.record_fork_switch( branches.second.size() );
 
             // push all blocks on the new fork
             for( auto ritr = branches.first.rbegin(); ritr != branches.first.rend(); ++ritr )
@@ -515,7 +549,7 @@ bool database::_push_block(const signed_block& new_block)
                 try
                 {
                    auto session = start_undo_session( true );
-                   apply_block( (*ritr)->data, skip );
+                   apply_fork_item( *ritr, skip );
                    session.push();
                 }
                 catch ( const fc::exception& e ) { except = e; }
@@ -525,20 +559,20 @@ bool database::_push_block(const signed_block& new_block)
                    // remove the rest of branches.first from the fork_db, those blocks are invalid
                    while( ritr != branches.first.rend() )
                    {
-                      _fork_db.remove( (*ritr)->data.id() );
+                      _fork_db.remove( (*ritr)->id );
                       ++ritr;
                    }
                    _fork_db.set_head( branches.second.front() );
 
                    // pop all blocks from the bad fork
-                   while( head_block_id() != branches.second.back()->data.previous )
+                   while( head_block_id() != branches.second.back()->previous )
                       pop_block();
 
                    // restore all blocks from the good fork
                    for( auto ritr = branches.second.rbegin(); ritr != branches.second.rend(); ++ritr )
                    {
                       auto session = start_undo_session( true );
-                      apply_block( (*ritr)->data, skip );
+                      apply_fork_item( *ritr, skip );
                       session.push();
                    }
                    throw *except;
@@ -554,7 +588,11 @@ bool database::_push_block(const signed_block& new_block)
    try
    {
       auto session = start_undo_session( true );
-      apply_block(new_block, skip);
+      // keep the validation results with the block in case a fork switch has to apply it again
+      if( new_head && new_head->id == new_block.id() )
+         apply_fork_item( new_head, skip );
+      else
+         apply_block(new_block, skip);
       session.push();
    }
    catch( const fc::exception& e )
@@ -567,6 +605,12 @@ bool database::_push_block(const signed_block& new_block)
    return false;
 } FC_CAPTURE_AND_RETHROW() }
 
+static size_t max_block_header_size()
+{
+   static const size_t size = fc::raw::pack_size( signed_block_header() ) + 4;
+   return size;
+}
+
 /**
  * Attempts to push the transaction into the pending queue
  *
@@ -604,27 +648,50 @@ void database::push_transaction( const signed_transaction& trx, uint32_t skip )
 }
 
 void database::_push_transaction( const signed_transaction& trx )
+{
+   _push_transaction( pending_transaction( trx ) );
+}
+
+void database::_push_transaction( pending_transaction&& trx )
 {
    // If this is the first transaction pushed after applying a block, start a new undo session.
    // This allows us to quickly rewind to the clean state of the head block, in case a new block arrives.
    if( !_pending_tx_session.valid() )
       _pending_tx_session = start_undo_session( true );
 
+   // Recover the signing keys once, _apply_transaction and every later re-apply use the cached ones.
+   if( !(get_node_properties().skip_flags & (skip_transaction_signatures | skip_authority_check)) )
+      _pending_tx.signature_keys( trx.trx, trx.id, SIGMAENGINE_CHAIN_ID );
+
    // Create a temporary undo session as a child of _pending_tx_session.
    // The temporary session will be discarded by the destructor if
    // _apply_transaction fails.  If we make it to merge(), we
    // apply the changes.
 
    auto temp_session = start_undo_session( true );
-   _apply_transaction( trx );
-   _pending_tx.push_back( trx );
+   _apply_transaction( trx.trx );
+   trx.fee = _current_trx_fee;
+   const auto& pending = _pending_tx.push_back( std::move( trx ) );
+
+   // Build the next block as transactions arrive, so producing it only takes the header and signature.
+   // Arrivals are appended in arrival order, so this is only done while that is the priority order.
+   if( !_speculative_tx_full && _pending_tx.keeps_arrival_order() )
+   {
+      if( max_block_header_size() + _speculative_tx_size + pending.packed_size < get_dynamic_global_properties().maximum_block_size )
+      {
+         _speculative_tx.push_back( pending.id );
+         _speculative_tx_size += pending.packed_size;
+      }
+      else
+         _speculative_tx_full = true;
+   }
 
    notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
    temp_session.squash();
 
    // notify anyone listening to pending transactions
-   notify_on_pending_transaction( trx );
+   notify_on_pending_transaction( pending.trx );
 }
 
 signed_block database::generate_block(
@@ -639,20 +706,49 @@ signed_block database::generate_block(
    {
       try
       {
-         result = _generate_block( when, bobserver_owner, block_signing_private_key );
+         bool speculative = true;
+         try
+         {
+            result = _generate_block( when, bobserver_owner, block_signing_private_key, speculative );
+         }
+         catch( const fc::exception& e )
+         {
+            if( !speculative )
+               throw;
+
+            wlog( "Speculatively assembled block failed to apply, assembling it again: ${e}", ("e", e.to_detail_string()) );
+            speculative = false;
+            result = _generate_block( when, bobserver_owner, block_signing_private_key, speculative );
+         }
       }
       FC_CAPTURE_AND_RETHROW( (bobserver_owner) )
    });
    return result;
 }
 
+void database::reset_speculative_block()
+{
+   _speculative_tx.clear();
+   _speculative_tx_size = 0;
+   _speculative_tx_full = false;
+}
+
 
+/**
+ * When speculative is true and the pending state holds a speculative block, its transactions
+ * are taken as they are, leaving only the header and signature to be done here.  Otherwise, or
+ * if there is none, speculative is set to false and the pending transactions are re-applied.
+ */
 signed_block database::_generate_block(
    fc::time_point_sec when,
    const account_name_type& bobserver_owner,
-   const fc::ecc::private_key& block_signing_private_key
+   const fc::ecc::private_key& block_signing_private_key,
+   bool& speculative
    )
 {
+   bool try_speculative = speculative;
+   speculative = false;
+
    uint32_t skip = get_node_properties().skip_flags;
    uint32_t slot_num = get_slot_at_time( when );
    FC_ASSERT( slot_num > 0 );
@@ -664,14 +760,33 @@ signed_block database::_generate_block(
    if( !(skip & skip_bobserver_signature) )
       FC_ASSERT( bobserver_obj.signing_key == block_signing_private_key.get_public_key() );
 
-   static const size_t max_block_header_size = fc::raw::pack_size( signed_block_header() ) + 4;
    auto maximum_block_size = get_dynamic_global_properties().maximum_block_size; //SIGMAENGINE_MAX_BLOCK_SIZE;
-   size_t total_block_size = max_block_header_size;
+   size_t total_block_size = max_block_header_size();
 
    signed_block pending_block;
 
    with_write_lock( [&]()
    {
+      // the speculative block is only complete if every pending transaction made it in, or it is full
+      speculative = try_speculative && _pending_tx_session.valid() && _pending_tx.keeps_arrival_order()
+         && ( _speculative_tx_full || _speculative_tx.size() == _pending_tx.size() );
+
+      if( speculative )
+      {
+         for( const auto& id : _speculative_tx )
+         {
+            const pending_transaction* ptx = _pending_tx.find( id );
+
+            // stopping at the first transaction left out keeps the rest applicable in order
+            if( ptx == nullptr || ptx->trx.expiration < when || total_block_size + ptx->packed_size >= maximum_block_size )
+               break;
+
+            total_block_size += ptx->packed_size;
+            pending_block.transactions.push_back( ptx->trx );
+         }
+         return;
+      }
+
       //
       // The following code throws away existing pending_tx_session and
       // rebuilds it by re-applying pending transactions.
@@ -687,16 +802,30 @@ signed_block database::_generate_block(
       _pending_tx_session = start_undo_session( true );
 
       uint64_t postponed_tx_count = 0;
+      uint64_t considered_tx_count = 0;
+      vector< transaction_id_type > failed_tx;
+      const uint32_t min_tx_size = _pending_tx.min_packed_size();
+
       // pop pending state (reset to head block state)
-      for( const signed_transaction& tx : _pending_tx )
+      for( const pending_transaction& ptx : _pending_tx.prioritized() )
       {
+         // once not even the smallest pending transaction fits, the rest can only be postponed
+         if( total_block_size + min_tx_size >= maximum_block_size )
+         {
+            postponed_tx_count += _pending_tx.size() - considered_tx_count;
+            break;
+         }
+         ++considered_tx_count;
+
+         const signed_transaction& tx = ptx.trx;
+
          // Only include transactions that have not expired yet for currently generating block,
          // this should clear problem transactions and allow block production to continue
 
          if( tx.expiration < when )
             continue;
 
-         uint64_t new_total_size = total_block_size + fc::raw::pack_size( tx );
+         uint64_t new_total_size = total_block_size + ptx.packed_size;
 
          // postpone transaction if it would make block too big
          if( new_total_size >= maximum_block_size )
@@ -711,12 +840,12 @@ signed_block database::_generate_block(
             _apply_transaction( tx );
             temp_session.squash();
 
-            total_block_size += fc::raw::pack_size( tx );
+            total_block_size += ptx.packed_size;
             pending_block.transactions.push_back( tx );
          }
          catch ( const fc::exception& e )
          {
-            // Do nothing, transaction will not be re-applied
+            failed_tx.push_back( ptx.id );
             //wlog( "Transaction was not processed while generating block due to ${e}", ("e", e) );
             //wlog( "The transaction was ${t}", ("t", tx) );
          }
@@ -726,7 +855,12 @@ signed_block database::_generate_block(
          wlog( "Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count) );
       }
 
+      // evicted, so a transaction that broke the speculative block is not assembled into the next one
+      for( const auto& id : failed_tx )
+         _pending_tx.remove( id );
+
       _pending_tx_session.reset();
+      reset_speculative_block();
    });
 
    // We have temporarily broken the invariant that
@@ -787,6 +921,7 @@ void database::pop_block()
    try
    {
       _pending_tx_session.reset();
+      reset_speculative_block();
       auto head_id = head_block_id();
 
       /// save the head block so we can recover its transactions
@@ -809,6 +944,7 @@ void database::clear_pending()
       assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
       _pending_tx.clear();
       _pending_tx_session.reset();
+      reset_speculative_block();
    }
    FC_CAPTURE_AND_RETHROW()
 }
@@ -831,6 +967,13 @@ void database::notify_post_apply_operation( const operation_notification& note )
 void database::push_virtual_operation( const operation& op, bool force )
 {
    FC_ASSERT( is_virtual_operation( op ) );
+
+   // every fee an evaluator charges, including the dapp fee of plugin operations, is reported as one of these
+   if( op.which() == operation::tag< tx_fee_virtual_operation >::value )
+      _current_trx_fee += op.get< tx_fee_virtual_operation >().reward.amount.value;
+   else if( op.which() == operation::tag< dapp_fee_virtual_operation >::value )
+      _current_trx_fee += op.get< dapp_fee_virtual_operation >().reward.amount.value;
+
    operation_notification note(op);
    ++_current_virtual_op;
    note.virtual_op = _current_virtual_op;
@@ -1470,6 +1613,20 @@ void database::set_flush_interval( uint32_t flush_blocks )
    _next_flush_block = 0;
 }
 
+void database::set_block_log_write_policy( uint32_t max_unsynced_blocks, block_log::sync_policy policy )
+{
+   _block_log.set_write_policy( max_unsynced_blocks, policy );
+}
+
+void database::set_pending_transaction_priority( pending_priority_type priority )
+{
+   with_write_lock( [&]()
+   {
+      _pending_tx.set_priority( std::move( priority ) );
+      reset_speculative_block();
+   });
+}
+
 //////////////////// private methods ////////////////////
 
 void database::apply_block( const signed_block& next_block, uint32_t skip )
@@ -1537,6 +1694,8 @@ void database::apply_block( const signed_block& next_block, uint32_t skip )
       {
          _next_flush_block = 0;
          //ilog( "Flushing database shared memory at block ${b}", ("b", block_num) );
+         // the shared memory file must never be on disk ahead of the block log
+         _block_log.flush();
          chainbase::database::flush();
       }
    }
@@ -1572,8 +1731,106 @@ uint32_t database::get_free_memory_gb()
    //return 0;
 }
 
+void database::apply_fork_item( const item_ptr& item, uint32_t skip )
+{
+   _current_fork_item = item.get();
+   try
+   {
+      auto block = item->data();
+      item->signature_keys.resize( block->transactions.size() );
+      if( !( skip & (skip_transaction_signatures | skip_authority_check) ) )
+         recover_signature_keys( *item );
+      apply_block( *block, skip );
+   }
+   catch( ... )
+   {
+      _current_fork_item = nullptr;
+      throw;
+   }
+   _current_fork_item = nullptr;
+}
+
+/**
+ * Checks of a fork database item that do not depend on state.  The results are
+ * cached in the item, so applying it afterwards does not repeat the work.
+ */
+void database::prevalidate_fork_item( fork_item& item, uint32_t skip )
+{ try {
+   FC_ASSERT( !item.invalid, "Block was marked invalid", ("id", item.id) );
+   FC_ASSERT( item.packed_block->size() <= SIGMAENGINE_MAX_BLOCK_SIZE, "Block Size is too Big", ("id", item.id) );
+
+   auto block = item.data();
+
+   if( !( skip & skip_merkle_check ) )
+   {
+      if( !item.merkle_root )
+         item.merkle_root = block->calculate_merkle_root();
+      FC_ASSERT( block->transaction_merkle_root == *item.merkle_root, "Merkle check failed",
+                 ("next_block.transaction_merkle_root",block->transaction_merkle_root)("calc",*item.merkle_root)("id",item.id) );
+   }
+
+   // the signing keys are checked against the bobservers and accounts once the block is applied
+   if( !( skip & skip_bobserver_signature ) && !item.signee )
+      item.signee = block->signee();
+
+   if( !( skip & (skip_transaction_signatures | skip_authority_check) ) )
+      recover_signature_keys( item );
+} FC_CAPTURE_AND_RETHROW( (item.id) ) }
+
+/**
+ * Recovers the signing keys of every transaction of the block in one batch, except for those
+ * already known to the fork item or to the pending queue.
+ */
+void database::recover_signature_keys( fork_item& item )
+{
+   const chain_id_type& chain_id = SIGMAENGINE_CHAIN_ID;
+   auto block = item.data();
+   item.signature_keys.resize( block->transactions.size() );
+
+   vector< std::pair< fc::sha256, fc::ecc::compact_signature > > batch;
+   vector< size_t > owners;
+   for( size_t i = 0; i < block->transactions.size(); ++i )
+   {
+      const auto& trx = block->transactions[i];
+      if( item.signature_keys[i] || _pending_tx.find_signature_keys( trx, item.transaction_id( i ) ) != nullptr )
+         continue;
+
+      auto digest = trx.sig_digest( chain_id );
+      for( const auto& sig : trx.signatures )
+      {
+         batch.emplace_back( digest, sig );
+         owners.push_back( i );
+      }
+   }
+   if( batch.empty() )
+      return;
+
+   auto keys = fc::ecc::public_key::recover( batch );
+   for( size_t j = 0; j < keys.size(); ++j )
+   {
+      auto& trx_keys = item.signature_keys[ owners[j] ];
+      if( !trx_keys )
+         trx_keys = flat_set< public_key_type >();
+      if( !trx_keys->insert( keys[j] ).second )
+      {
+         // let the transaction report its duplicate signature
+         trx_keys.reset();
+         block->transactions[ owners[j] ].get_signature_keys( chain_id );
+      }
+   }
+}
+
 void database::_apply_block( const signed_block& next_block )
 { try {
+   // authorities resolved for the block are dropped once it is applied, or undone after failing to apply
+   _authority_cache.clear();
+   _authority_cache_block = true;
+   auto authority_cache_reset = fc::make_scoped_exit( [&]()
+   {
+      _authority_cache.clear();
+      _authority_cache_block = false;
+   } );
+
    notify_pre_apply_block( next_block );
 
    uint32_t next_block_num = next_block.block_num();
@@ -1583,7 +1840,15 @@ void database::_apply_block( const signed_block& next_block )
 
    if( !( skip & skip_merkle_check ) )
    {
-      auto merkle_root = next_block.calculate_merkle_root();
+      checksum_type merkle_root;
+      if( _current_fork_item != nullptr && _current_fork_item->merkle_root )
+         merkle_root = *_current_fork_item->merkle_root;
+      else
+      {
+         merkle_root = next_block.calculate_merkle_root();
+         if( _current_fork_item != nullptr )
+            _current_fork_item->merkle_root = merkle_root;
+      }
 
       try
       {
@@ -1754,8 +2019,13 @@ void database::apply_transaction(const signed_transaction& trx, uint32_t skip)
 
 void database::_apply_transaction(const signed_transaction& trx)
 { try {
-   _current_trx_id = trx.id();
+   // a block applied from the fork database hashes each of its transactions once
+   if( _current_fork_item != nullptr && _current_trx_in_block < _current_fork_item->signature_keys.size() )
+      _current_trx_id = _current_fork_item->transaction_id( _current_trx_in_block );
+   else
+      _current_trx_id = trx.id();
    _current_virtual_op   = 0;
+   _current_trx_fee      = 0;
    uint32_t skip = get_node_properties().skip_flags;
 
    if( !(skip&skip_validate) )   /* issue #505 explains why this skip_flag is disabled */
@@ -1763,7 +2033,7 @@ void database::_apply_transaction(const signed_transaction& trx)
 
    auto& trx_idx = get_index<transaction_index>();
    const chain_id_type& chain_id = SIGMAENGINE_CHAIN_ID;
-   auto trx_id = trx.id();
+   auto trx_id = _current_trx_id;
    // idump((trx_id)(skip&skip_transaction_dupe_check));
    FC_ASSERT( (skip & skip_transaction_dupe_check) ||
               trx_idx.indices().get<by_trx_id>().find(trx_id) == trx_idx.indices().get<by_trx_id>().end(),
@@ -1771,13 +2041,33 @@ void database::_apply_transaction(const signed_transaction& trx)
 
    if( !(skip & (skip_transaction_signatures | skip_authority_check) ) )
    {
-      auto get_active  = [&]( const string& name ) { return authority( get< account_authority_object, by_account >( name ).active ); };
-      auto get_owner   = [&]( const string& name ) { return authority( get< account_authority_object, by_account >( name ).owner );  };
-      auto get_posting = [&]( const string& name ) { return authority( get< account_authority_object, by_account >( name ).posting );  };
+      if( !_authority_cache_block )
+         _authority_cache.clear();
+
+      auto get_active  = [&]( const string& name ) { return resolve_authority( name, authority::active ).auth; };
+      auto get_owner   = [&]( const string& name ) { return resolve_authority( name, authority::owner ).auth; };
+      auto get_posting = [&]( const string& name ) { return resolve_authority( name, authority::posting ).auth; };
 
       try
       {
-         trx.verify_authority( chain_id, get_active, get_owner, get_posting, SIGMAENGINE_MAX_SIG_CHECK_DEPTH );
+         // transactions that went through the pending queue, or were applied before a fork switch,
+         // already had their signing keys recovered
+         const auto* signature_keys = _pending_tx.find_signature_keys( trx, trx_id );
+         if( signature_keys == nullptr && _current_fork_item != nullptr && _current_trx_in_block < _current_fork_item->signature_keys.size() )
+         {
+            auto& keys = _current_fork_item->signature_keys;
+            if( !keys[ _current_trx_in_block ] )
+               keys[ _current_trx_in_block ] = trx.get_signature_keys( chain_id );
+            signature_keys = &*keys[ _current_trx_in_block ];
+         }
+         flat_set< public_key_type > recovered_keys;
+         if( signature_keys == nullptr )
+         {
+            recovered_keys = trx.get_signature_keys( chain_id );
+            signature_keys = &recovered_keys;
+         }
+         if( !verify_single_key_authority( trx, *signature_keys ) )
+            protocol::verify_authority( trx.operations, *signature_keys, get_active, get_owner, get_posting, SIGMAENGINE_MAX_SIG_CHECK_DEPTH );
       }
       catch( protocol::tx_missing_active_auth& e )
       {
@@ -1837,9 +2127,80 @@ void database::apply_operation(const operation& op)
    operation_notification note(op);
    notify_pre_apply_operation( note );
    _my->_evaluator_registry.get_evaluator( op ).apply( op );
+
+   // the only operations changing the authorities of an existing account
+   if( op.which() == operation::tag< account_update_operation >::value )
+      invalidate_authority_cache( op.get< account_update_operation >().account );
+   else if( op.which() == operation::tag< recover_account_operation >::value )
+      invalidate_authority_cache( op.get< recover_account_operation >().account_to_recover );
+
    notify_post_apply_operation( note );
 }
 
+const database::resolved_authority& database::resolve_authority( const account_name_type& name, authority::classification level )
+{
+   auto key = std::make_pair( name, level );
+   auto itr = _authority_cache.find( key );
+   if( itr != _authority_cache.end() )
+      return itr->second;
+
+   const auto& auth_obj = get< account_authority_object, by_account >( name );
+   resolved_authority resolved;
+   switch( level )
+   {
+      case authority::owner:
+         resolved.auth = authority( auth_obj.owner );
+         break;
+      case authority::posting:
+         resolved.auth = authority( auth_obj.posting );
+         break;
+      default:
+         resolved.auth = authority( auth_obj.active );
+         break;
+   }
+
+   const auto& auth = resolved.auth;
+   if( auth.account_auths.empty() && auth.key_auths.size() == 1 && auth.key_auths.begin()->second >= auth.weight_threshold )
+      resolved.single_key = auth.key_auths.begin()->first;
+
+   return _authority_cache.emplace( key, std::move( resolved ) ).first->second;
+}
+
+void database::invalidate_authority_cache( const account_name_type& name )
+{
+   _authority_cache.erase( std::make_pair( name, authority::owner ) );
+   _authority_cache.erase( std::make_pair( name, authority::active ) );
+   _authority_cache.erase( std::make_pair( name, authority::posting ) );
+}
+
+bool database::verify_single_key_authority( const signed_transaction& trx, const flat_set< public_key_type >& sigs )
+{
+   flat_set< account_name_type > required_active, required_owner, required_posting;
+   vector< authority > other;
+   trx.get_required_authorities( required_active, required_owner, required_posting, other );
+
+   if( !required_owner.empty() || !other.empty() || required_active.empty() == required_posting.empty() )
+      return false;
+
+   const auto& required = required_active.empty() ? required_posting : required_active;
+   auto level = required_active.empty() ? authority::posting : authority::active;
+
+   // sign_state approves this name without looking at its authority
+   if( required.find( "temp" ) != required.end() )
+      return false;
+
+   // every signature must be used by one of the authorities, or verify_authority rejects the transaction
+   flat_set< public_key_type > used;
+   for( const auto& name : required )
+   {
+      const auto& resolved = resolve_authority( name, level );
+      if( !resolved.single_key || sigs.find( *resolved.single_key ) == sigs.end() )
+         return false;
+      used.insert( *resolved.single_key );
+   }
+   return used.size() == sigs.size();
+}
+
 const bobserver_object& database::validate_block_header( uint32_t skip, const signed_block& next_block )const
 { try {
    FC_ASSERT( head_block_id() == next_block.previous, "", ("head_block_id",head_block_id())("next.prev",next_block.previous) );
@@ -1847,7 +2208,16 @@ const bobserver_object& database::validate_block_header( uint32_t skip, const si
    const bobserver_object& bobserver = get_bobserver( next_block.bobserver );
 
    if( !(skip&skip_bobserver_signature) )
-      FC_ASSERT( next_block.validate_signee( bobserver.signing_key ) );
+   {
+      if( _current_fork_item != nullptr )
+      {
+         if( !_current_fork_item->signee )
+            _current_fork_item->signee = next_block.signee();
+         FC_ASSERT( *_current_fork_item->signee == bobserver.signing_key );
+      }
+      else
+         FC_ASSERT( next_block.validate_signee( bobserver.signing_key ) );
+   }
 
    if( !(skip&skip_bobserver_schedule_check) )
    {
@@ -1984,8 +2354,8 @@ void database::update_last_irreversible_block()
       }
    }
 
-   commit( dpo.last_irreversible_block_num );
-
+   // the blocks are written to the block log before they become irreversible in the shared memory file,
+   // so a node that stops at any point reopens with every irreversible block in the log
    if( !( get_node_properties().skip_flags & skip_block_log ) )
    {
       // output to block log based on new last irreverisible block num
@@ -2001,15 +2371,16 @@ void database::update_last_irreversible_block()
          {
             shared_ptr< fork_item > block = _fork_db.fetch_block_on_main_branch_by_number( log_head_num+1 );
             FC_ASSERT( block, "Current fork in the fork database does not contain the last_irreversible_block" );
-            _block_log.append( block->data );
+            _block_log.append( block->block() );
             log_head_num++;
          }
-
-         _block_log.flush();
       }
    }
 
+   commit( dpo.last_irreversible_block_num );
+
    _fork_db.set_max_size( dpo.head_block_number - dpo.last_irreversible_block_num + 1 );
+   _fork_db.prune( dpo.last_irreversible_block_num );
 } FC_CAPTURE_AND_RETHROW() }
 
 void database::clear_expired_transactions()
@@ -2180,6 +2551,10 @@ void database::init_hardforks()
    FC_ASSERT( SIGMAENGINE_HARDFORK_0_1 == 1, "Invalid hardfork configuration : 0.1" );
    _hardfork_times[ SIGMAENGINE_HARDFORK_0_1 ] = fc::time_point_sec( SIGMAENGINE_HARDFORK_0_1_TIME );
    _hardfork_versions[ SIGMAENGINE_HARDFORK_0_1 ] = SIGMAENGINE_HARDFORK_0_1_VERSION;
+
+   FC_ASSERT( SIGMAENGINE_HARDFORK_0_2 == 2, "Invalid hardfork configuration : 0.2" );
+   _hardfork_times[ SIGMAENGINE_HARDFORK_0_2 ] = fc::time_point_sec( SIGMAENGINE_HARDFORK_0_2_TIME );
+   _hardfork_versions[ SIGMAENGINE_HARDFORK_0_2 ] = SIGMAENGINE_HARDFORK_0_2_VERSION;
    
    const auto& hardforks = get_hardfork_property_object();
    FC_ASSERT( hardforks.last_hardfork <= SIGMAENGINE_NUM_HARDFORKS, "Chain knows of more hardforks than configuration", ("hardforks.last_hardfork",hardforks.last_hardfork)("SIGMAENGINE_NUM_HARDFORKS",SIGMAENGINE_NUM_HARDFORKS) );
@@ -2256,6 +2631,9 @@ void database::apply_hardfork( uint32_t hardfork )
       case SIGMAENGINE_HARDFORK_0_1:
          break;
 
+      case SIGMAENGINE_HARDFORK_0_2:
+         break;
+
       default:
          break;
    }
@@ -2,8 +2,61 @@
 
 #include <sigmaengine/chain/database_exceptions.hpp>
 
+#include <fc/io/raw.hpp>
+
+#include <set>
+
 namespace sigmaengine { namespace chain {
 
+fork_item::fork_item( signed_block d, std::shared_ptr< const vector< char > > packed )
+   : num( d.block_num() ), id( d.id() ), previous( d.previous ), packed_block( std::move( packed ) ),
+     _data( std::make_shared< const signed_block >( std::move( d ) ) )
+{
+   // a peer may encode the block in more bytes than it packs to, the block size limit is checked on the packed size
+   if( !packed_block || packed_block->size() != fc::raw::pack_size( *_data ) )
+      packed_block = std::make_shared< const vector< char > >( fc::raw::pack( *_data ) );
+}
+
+std::shared_ptr< const signed_block > fork_item::data()const
+{
+   // API threads read the fork database concurrently under the read lock
+   auto result = std::atomic_load( &_data );
+   if( !result )
+   {
+      result = std::make_shared< const signed_block >( fc::raw::unpack< signed_block >( *packed_block ) );
+      std::atomic_store( &_data, result );
+   }
+   return result;
+}
+
+signed_block fork_item::block()const
+{
+   auto result = std::atomic_load( &_data );
+   if( result )
+      return *result;
+   return fc::raw::unpack< signed_block >( *packed_block );
+}
+
+void fork_item::release()const
+{
+   std::atomic_store( &_data, std::shared_ptr< const signed_block >() );
+}
+
+bool fork_item::is_unpacked()const
+{
+   return bool( std::atomic_load( &_data ) );
+}
+
+const protocol::transaction_id_type& fork_item::transaction_id( uint32_t i )
+{
+   auto block = data();
+   FC_ASSERT( i < block->transactions.size() );
+   transaction_ids.resize( block->transactions.size() );
+   if( !transaction_ids[i] )
+      transaction_ids[i] = block->transactions[i].id();
+   return *transaction_ids[i];
+}
+
 fork_database::fork_database()
 {
 }
@@ -11,6 +64,7 @@ void fork_database::reset()
 {
    _head.reset();
    _index.clear();
+   _irreversible_num = 0;
 }
 
 void fork_database::pop_block()
@@ -32,19 +86,23 @@ void     fork_database::start_block(signed_block b)
  * Pushes the block into the fork database and caches it if it doesn't link
  *
  */
-shared_ptr<fork_item>  fork_database::push_block(const signed_block& b)
+shared_ptr<fork_item>  fork_database::push_block(const signed_block& b, std::shared_ptr< const vector< char > > packed)
 {
-   auto item = std::make_shared<fork_item>(b);
+   auto item = std::make_shared<fork_item>(b, std::move(packed));
    try {
       _push_block(item);
    }
    catch ( const unlinkable_block_exception& e )
    {
-      wlog( "Pushing block to fork database that failed to link: ${id}, ${num}", ("id",b.id())("num",b.block_num()) );
-      wlog( "Head: ${num}, ${id}", ("num",_head->data.block_num())("id",_head->data.id()) );
+      wlog( "Pushing block to fork database that failed to link: ${id}, ${num}", ("id",item->id)("num",item->num) );
+      wlog( "Head: ${num}, ${id}", ("num",_head->num)("id",_head->id) );
       throw;
       _unlinked_index.insert( item );
    }
+
+   // only a block that is about to be applied is kept unpacked
+   if( _head != item )
+      item->release();
    return _head;
 }
 
@@ -55,6 +113,8 @@ void  fork_database::_push_block(const item_ptr& item)
       FC_ASSERT( item->num > std::max<int64_t>( 0, int64_t(_head->num) - (_max_size) ),
                  "attempting to push a block that is too old",
                  ("item->num",item->num)("head",_head->num)("max_size",_max_size));
+      FC_ASSERT( item->num > _irreversible_num, "attempting to push a block that is not after the last irreversible block",
+                 ("item->num",item->num)("last_irreversible_block_num",_irreversible_num) );
    }
 
    if( _head && item->previous_id() != block_id_type() )
@@ -64,6 +124,9 @@ void  fork_database::_push_block(const item_ptr& item)
       SIGMAENGINE_ASSERT(itr != index.end(), unlinkable_block_exception, "block does not link to known chain");
       FC_ASSERT(!(*itr)->invalid);
       item->prev = *itr;
+
+      // the parent was applied when it was pushed, a fork switch unpacks it again
+      (*itr)->release();
    }
 
    _index.insert(item);
@@ -180,19 +243,19 @@ pair<fork_database::branch_type,fork_database::branch_type>
    auto second_branch = *second_branch_itr;
 
 
-   while( first_branch->data.block_num() > second_branch->data.block_num() )
+   while( first_branch->num > second_branch->num )
    {
       result.first.push_back(first_branch);
       first_branch = first_branch->prev.lock();
       FC_ASSERT(first_branch);
    }
-   while( second_branch->data.block_num() > first_branch->data.block_num() )
+   while( second_branch->num > first_branch->num )
    {
       result.second.push_back( second_branch );
       second_branch = second_branch->prev.lock();
       FC_ASSERT(second_branch);
    }
-   while( first_branch->data.previous != second_branch->data.previous )
+   while( first_branch->previous != second_branch->previous )
    {
       result.first.push_back(first_branch);
       result.second.push_back(second_branch);
@@ -240,4 +303,101 @@ void fork_database::remove(block_id_type id)
    _index.get<block_id>().erase(id);
 }
 
+void fork_database::prune( uint32_t last_irreversible_block_num )
+{
+   if( !_head || last_irreversible_block_num <= _irreversible_num )
+      return;
+
+   auto root = walk_main_branch_to_num( last_irreversible_block_num );
+   if( !root || root->num != last_irreversible_block_num )
+      return;
+   _irreversible_num = last_irreversible_block_num;
+
+   auto& by_num_idx = _index.get<block_num>();
+   while( !by_num_idx.empty() && (*by_num_idx.begin())->num < _irreversible_num )
+   {
+      by_num_idx.erase( by_num_idx.begin() );
+      ++_pruned_blocks;
+   }
+
+   // blocks competing with the irreversible block, and everything built on them, can never be applied
+   vector< block_id_type > dead;
+   for( auto itr = by_num_idx.lower_bound( _irreversible_num ); itr != by_num_idx.end() && (*itr)->num == _irreversible_num; ++itr )
+   {
+      if( (*itr)->id != root->id )
+         dead.push_back( (*itr)->id );
+   }
+
+   auto& by_id_idx = _index.get<block_id>();
+   auto& by_prev_idx = _index.get<by_previous>();
+   while( !dead.empty() )
+   {
+      block_id_type id = dead.back();
+      dead.pop_back();
+
+      auto children = by_prev_idx.equal_range( id );
+      for( auto itr = children.first; itr != children.second; ++itr )
+         dead.push_back( (*itr)->id );
+
+      by_id_idx.erase( id );
+      ++_pruned_blocks;
+   }
+
+   auto& unlinked_by_num_idx = _unlinked_index.get<block_num>();
+   while( !unlinked_by_num_idx.empty() && (*unlinked_by_num_idx.begin())->num <= _irreversible_num )
+   {
+      unlinked_by_num_idx.erase( unlinked_by_num_idx.begin() );
+      ++_pruned_blocks;
+   }
+}
+
+void fork_database::record_fork_switch( uint32_t depth )
+{
+   ++_fork_switches;
+   _last_fork_switch_depth = depth;
+   _max_fork_switch_depth = std::max( _max_fork_switch_depth, depth );
+}
+
+fork_database_metrics fork_database::get_metrics()const
+{
+   fork_database_metrics result;
+   result.blocks = _index.size();
+   result.unlinked_blocks = _unlinked_index.size();
+   result.irreversible_block_num = _irreversible_num;
+   result.pruned_blocks = _pruned_blocks;
+   result.fork_switches = _fork_switches;
+   result.last_fork_switch_depth = _last_fork_switch_depth;
+   result.max_fork_switch_depth = _max_fork_switch_depth;
+
+   std::set< block_id_type > main_branch;
+   for( auto item = _head; item; item = item->prev.lock() )
+      main_branch.insert( item->id );
+
+   auto count = [&]( const fork_multi_index_type& index )
+   {
+      for( const auto& item : index )
+      {
+         result.packed_bytes += item->packed_block->size();
+         if( item->is_unpacked() )
+            ++result.unpacked_blocks;
+      }
+   };
+   count( _index );
+   count( _unlinked_index );
+
+   for( const auto& item : _index )
+   {
+      if( main_branch.find( item->id ) != main_branch.end() )
+         continue;
+
+      ++result.fork_blocks;
+      uint32_t depth = 1;
+      for( auto prev = item->prev.lock(); prev && main_branch.find( prev->id ) == main_branch.end(); prev = prev->prev.lock() )
+         ++depth;
+      result.fork_depth = std::max( result.fork_depth, depth );
+   }
+
+   return result;
+}
+
 } } // sigmaengine::chain
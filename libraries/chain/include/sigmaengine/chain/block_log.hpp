@@ -31,18 +31,39 @@ namespace sigmaengine { namespace chain {
     *
     * The main file is the only file that needs to persist. The index file can be reconstructed during a
     * linear scan of the main file.
+    *
+    * append writes the block to both files before it returns, so a block is in the files before it
+    * becomes irreversible in the shared memory file. Getting the files to disk is left to the sync
+    * policy; under the batch policy a background thread syncs whatever was appended since its last
+    * sync. A block that was only partly written when the node stopped is cut off the end of the main
+    * file on open, and the index is reconstructed when it does not match.
     */
 
    class block_log {
       public:
+         enum sync_policy
+         {
+            sync_none,     ///< leave writing the files to disk to the operating system
+            sync_flush,    ///< fsync the files when flush() is called
+            sync_batch     ///< fsync the files from a background thread, after every group of blocks appended
+         };
+
          block_log();
          ~block_log();
 
+         /**
+          * Takes effect on the next open.  Under sync_batch, append waits for the sync thread once
+          * max_unsynced_blocks blocks were appended and not synced yet.
+          */
+         void set_write_policy( uint32_t max_unsynced_blocks, sync_policy policy );
+
          void open( const fc::path& file );
          void close();
          bool is_open()const;
 
          uint64_t append( const signed_block& b );
+
+         /** Syncs every appended block to disk, unless the policy is sync_none */
          void flush();
          std::pair< signed_block, uint64_t > read_block( uint64_t file_pos )const;
          optional< signed_block > read_block_by_num( uint32_t block_num )const;
@@ -60,6 +81,8 @@ namespace sigmaengine { namespace chain {
          void construct_index();
 
          std::unique_ptr<detail::block_log_impl> my;
+         uint32_t                                _max_unsynced_blocks = 1024;
+         sync_policy                             _sync_policy = sync_flush;
    };
 
 } }
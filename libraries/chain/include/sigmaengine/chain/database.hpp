@@ -6,6 +6,7 @@
 #include <sigmaengine/chain/hardfork_property_object.hpp>
 #include <sigmaengine/chain/node_property_object.hpp>
 #include <sigmaengine/chain/fork_database.hpp>
+#include <sigmaengine/chain/transaction_pool.hpp>
 #include <sigmaengine/chain/block_log.hpp>
 #include <sigmaengine/chain/operation_notification.hpp>
 
@@ -111,6 +112,7 @@ namespace sigmaengine { namespace chain {
          optional<signed_block>     fetch_block_by_number( uint32_t num )const;
          const signed_transaction   get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type> get_block_ids_on_fork(block_id_type head_of_fork) const;
+         fork_database_metrics      get_fork_db_metrics()const;
 
          chain_id_type             get_chain_id()const;
 
@@ -146,11 +148,14 @@ namespace sigmaengine { namespace chain {
          const flat_map<uint32_t,block_id_type> get_checkpoints()const { return _checkpoints; }
          bool                                   before_last_checkpoint()const;
 
-         bool push_block( const signed_block& b, uint32_t skip = skip_nothing );
+         /** packed_block is the block as received from a peer, the fork database keeps it instead of packing the block again */
+         bool push_block( const signed_block& b, uint32_t skip = skip_nothing,
+                          std::shared_ptr< const vector< char > > packed_block = std::shared_ptr< const vector< char > >() );
          void push_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          void _maybe_warn_multiple_production( uint32_t height )const;
-         bool _push_block( const signed_block& b );
+         bool _push_block( const signed_block& b, std::shared_ptr< const vector< char > > packed_block = std::shared_ptr< const vector< char > >() );
          void _push_transaction( const signed_transaction& trx );
+         void _push_transaction( pending_transaction&& trx );
 
          signed_block generate_block(
             const fc::time_point_sec when,
@@ -161,7 +166,8 @@ namespace sigmaengine { namespace chain {
          signed_block _generate_block(
             const fc::time_point_sec when,
             const account_name_type& bobserver_owner,
-            const fc::ecc::private_key& block_signing_private_key
+            const fc::ecc::private_key& block_signing_private_key,
+            bool& speculative
             );
 
          void pop_block();
@@ -337,6 +343,12 @@ namespace sigmaengine { namespace chain {
          const std::string& get_json_schema() const;
 
          void set_flush_interval( uint32_t flush_blocks );
+
+         /** Sets how many irreversible blocks may wait for the block log writer and when the block log is synced, see block_log */
+         void set_block_log_write_policy( uint32_t max_unsynced_blocks, block_log::sync_policy policy );
+
+         /** Sets the order block generation takes pending transactions in, see transaction_pool */
+         void set_pending_transaction_priority( pending_priority_type priority );
          void show_free_memory( bool force );
          // bool skip_transaction_delta_check = true;
 
@@ -365,6 +377,9 @@ namespace sigmaengine { namespace chain {
          optional< chainbase::database::session > _pending_tx_session;
 
          void apply_block( const signed_block& next_block, uint32_t skip = skip_nothing );
+         void apply_fork_item( const item_ptr& item, uint32_t skip );
+         void prevalidate_fork_item( fork_item& item, uint32_t skip );
+         void recover_signature_keys( fork_item& item );
          void apply_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          void _apply_block( const signed_block& next_block );
          void _apply_transaction( const signed_transaction& trx );
@@ -393,7 +408,19 @@ namespace sigmaengine { namespace chain {
 
          std::unique_ptr< database_impl > _my;
 
-         vector< signed_transaction >  _pending_tx;
+         transaction_pool              _pending_tx;
+
+         /**
+          * The longest prefix of the pending transactions, in the order they were applied to the
+          * pending state, that fits in a block.  Applying them in this order on top of the head
+          * block is known to succeed, so block generation can take them without applying them
+          * again.  Reset whenever the pending state is.
+          */
+         vector< transaction_id_type > _speculative_tx;
+         uint64_t                      _speculative_tx_size = 0;
+         bool                          _speculative_tx_full = false;
+
+         void reset_speculative_block();
          fork_database                 _fork_db;
          fc::time_point_sec            _hardfork_times[ SIGMAENGINE_NUM_HARDFORKS + 1 ];
          protocol::hardfork_version    _hardfork_versions[ SIGMAENGINE_NUM_HARDFORKS + 1 ];
@@ -406,11 +433,41 @@ namespace sigmaengine { namespace chain {
 
          fc::signal< void() >          _plugin_index_signal;
 
+         /// the fork database item of the block being applied, if any, to reuse its validation results
+         fork_item*                    _current_fork_item = nullptr;
+
+         /// an account authority copied out of shared memory, with its key when one key satisfies it
+         struct resolved_authority
+         {
+            authority                     auth;
+            optional< public_key_type >   single_key;
+         };
+
+         /**
+          * Authorities resolved while applying a block, so accounts signing several transactions
+          * of the block are only looked up and converted once.  Outside of a block the cache only
+          * lives for one transaction, as undo sessions may roll back the authorities it holds.
+          */
+         std::map< std::pair< account_name_type, authority::classification >, resolved_authority > _authority_cache;
+         bool                          _authority_cache_block = false;
+
+         const resolved_authority& resolve_authority( const account_name_type& name, authority::classification level );
+         void invalidate_authority_cache( const account_name_type& name );
+
+         /**
+          * Returns true when the transaction only needs the active, or only the posting, authority
+          * of accounts satisfied by a single key, and is signed by exactly those keys.  This is the
+          * outcome of verify_authority for such transactions.  Returns false when the full check is
+          * needed.
+          */
+         bool verify_single_key_authority( const signed_transaction& trx, const flat_set< public_key_type >& sigs );
+
          transaction_id_type           _current_trx_id;
          uint32_t                      _current_block_num    = 0;
          uint16_t                      _current_trx_in_block = 0;
          uint16_t                      _current_op_in_trx    = 0;
          uint16_t                      _current_virtual_op   = 0;
+         int64_t                       _current_trx_fee      = 0;   ///< fees charged so far by the transaction being applied
 
          flat_map<uint32_t,block_id_type>  _checkpoints;
 
@@ -2,6 +2,8 @@
 
 #include <sigmaengine/chain/database.hpp>
 
+#include <algorithm>
+
 /*
  * This file provides with() functions which modify the database
  * temporarily, then restore it.  These functions are mostly internal
@@ -45,7 +47,7 @@ struct skip_flags_restorer
  */
 struct pending_transactions_restorer
 {
-   pending_transactions_restorer( database& db, std::vector<signed_transaction>&& pending_transactions )
+   pending_transactions_restorer( database& db, std::vector< pending_transaction >&& pending_transactions )
       : _db(db), _pending_transactions( std::move(pending_transactions) )
    {
       _db.clear_pending();
@@ -65,22 +67,30 @@ struct pending_transactions_restorer
          }
       }
       _db._popped_tx.clear();
-      for( const signed_transaction& tx : _pending_transactions )
+
+      // Re-apply in the order block generation takes transactions, so the pending state
+      // doubles as the speculative next block.
+      std::stable_sort( _pending_transactions.begin(), _pending_transactions.end(),
+         []( const pending_transaction& a, const pending_transaction& b ){ return a.priority > b.priority; } );
+
+      for( pending_transaction& tx : _pending_transactions )
       {
+         // drop transactions the block included, or that expired, without applying them
+         if( tx.trx.expiration <= _db.head_block_time() || _db.is_known_transaction( tx.id ) )
+            continue;
+
+         // the block may have changed any authority, directly or through account_auths, so the
+         // authority is always checked again, against the signing keys the pool already recovered
          try
          {
-            if( !_db.is_known_transaction( tx.id() ) ) {
-               // since push_transaction() takes a signed_transaction,
-               // the operation_results field will be ignored.
-               _db._push_transaction( tx );
-            }
+            _db._push_transaction( std::move( tx ) );
          }
          catch( const transaction_exception& e )
          {
             dlog( "Pending transaction became invalid after switching to block ${b} ${n} ${t}",
                ("b", _db.head_block_id())("n", _db.head_block_num())("t", _db.head_block_time()) );
             dlog( "The invalid transaction caused exception ${e}", ("e", e.to_detail_string()) );
-            dlog( "${t}", ("t", tx) );
+            dlog( "${t}", ("t", tx.trx) );
          }
          catch( const fc::exception& e )
          {
@@ -89,14 +99,14 @@ struct pending_transactions_restorer
             dlog( "Pending transaction became invalid after switching to block ${b} ${n} ${t}",
                ("b", _db.head_block_id())("n", _db.head_block_num())("t", _db.head_block_time()) );
             dlog( "The invalid pending transaction caused exception ${e}", ("e", e.to_detail_string() ) );
-            dlog( "${t}", ("t", tx) );
+            dlog( "${t}", ("t", tx.trx) );
             */
          }
       }
    }
 
    database& _db;
-   std::vector< signed_transaction > _pending_transactions;
+   std::vector< pending_transaction > _pending_transactions;
 };
 
 /**
@@ -121,12 +131,13 @@ void with_skip_flags(
  * Empty pending_transactions, call callback,
  * then reset pending_transactions after callback is done.
  *
- * Pending transactions which no longer validate will be culled.
+ * Pending transactions which no longer validate will be culled, and the ones
+ * the block included are dropped without being applied again.
  */
 template< typename Lambda >
 void without_pending_transactions(
    database& db,
-   std::vector<signed_transaction>&& pending_transactions,
+   std::vector< pending_transaction >&& pending_transactions,
    Lambda callback )
 {
     pending_transactions_restorer restorer( db, std::move(pending_transactions) );
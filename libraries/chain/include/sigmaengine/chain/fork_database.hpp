@@ -17,10 +17,26 @@ namespace sigmaengine { namespace chain {
 
    struct fork_item
    {
-      fork_item( signed_block d )
-      :num(d.block_num()),id(d.id()),data( std::move(d) ){}
+      /** packed is the block as a peer sent it, the block is only packed when it is missing */
+      fork_item( signed_block d, std::shared_ptr< const vector< char > > packed = std::shared_ptr< const vector< char > >() );
 
-      block_id_type previous_id()const { return data.previous; }
+      block_id_type previous_id()const { return previous; }
+
+      /**
+       * The block, unpacked from packed_block the first time it is needed after
+       * a release and kept until the next release.
+       */
+      std::shared_ptr< const signed_block > data()const;
+
+      /** A copy of the block that does not keep it unpacked */
+      signed_block                          block()const;
+
+      /** Drops the unpacked block, only packed_block is kept */
+      void                                  release()const;
+      bool                                  is_unpacked()const;
+
+      /** The id of the block's transaction at index i, hashed the first time it is needed */
+      const protocol::transaction_id_type&  transaction_id( uint32_t i );
 
       weak_ptr< fork_item > prev;
       uint32_t              num;    // initialized in ctor
@@ -30,11 +46,39 @@ namespace sigmaengine { namespace chain {
        */
       bool                  invalid = false;
       block_id_type         id;
-      signed_block          data;
+      block_id_type         previous;
+      std::shared_ptr< const vector< char > > packed_block;
+
+      /**
+       * Validation results, computed the first time they are needed and reused
+       * when a fork switch applies the block again.
+       */
+      optional< protocol::checksum_type >                         merkle_root;
+      optional< protocol::public_key_type >                       signee;
+      vector< optional< flat_set< protocol::public_key_type > > > signature_keys;  ///< per transaction
+      vector< optional< protocol::transaction_id_type > >         transaction_ids; ///< per transaction
+
+   private:
+      mutable std::shared_ptr< const signed_block > _data;
    };
    typedef shared_ptr<fork_item> item_ptr;
 
 
+   struct fork_database_metrics
+   {
+      uint32_t          blocks = 0;              ///< linked blocks
+      uint32_t          unlinked_blocks = 0;
+      uint32_t          unpacked_blocks = 0;     ///< blocks also held unpacked
+      uint64_t          packed_bytes = 0;        ///< size of the packed blocks held
+      uint32_t          fork_blocks = 0;         ///< linked blocks that are not on the main branch
+      uint32_t          fork_depth = 0;          ///< length of the longest branch off the main branch
+      uint32_t          irreversible_block_num = 0;
+      uint64_t          pruned_blocks = 0;       ///< blocks dropped as irreversible or off the irreversible chain
+      uint64_t          fork_switches = 0;
+      uint32_t          last_fork_switch_depth = 0;  ///< blocks popped by the last fork switch
+      uint32_t          max_fork_switch_depth = 0;
+   };
+
    /**
     *  As long as blocks are pushed in order the fork
     *  database will maintain a linked tree of all blocks
@@ -44,6 +88,12 @@ namespace sigmaengine { namespace chain {
     *
     *  Every time a block is pushed into the fork DB the
     *  block with the highest block_num will be returned.
+    *
+    *  Blocks are held packed.  A block stays unpacked until
+    *  another block builds on it, and is unpacked again on
+    *  demand when a fork switch applies it.  Once a block
+    *  becomes irreversible everything before it, and every
+    *  branch that does not lead to it, is pruned.
     */
    class fork_database
    {
@@ -65,10 +115,18 @@ namespace sigmaengine { namespace chain {
          /**
           *  @return the new head block ( the longest fork )
           */
-         shared_ptr<fork_item>            push_block(const signed_block& b);
+         shared_ptr<fork_item>            push_block(const signed_block& b, std::shared_ptr< const vector< char > > packed = std::shared_ptr< const vector< char > >());
          shared_ptr<fork_item>            head()const { return _head; }
          void                             pop_block();
 
+         /** Drops the blocks that can no longer be part of the chain once last_irreversible_block_num is irreversible */
+         void                             prune( uint32_t last_irreversible_block_num );
+
+         /** Records that the database popped depth blocks to switch to another branch */
+         void                             record_fork_switch( uint32_t depth );
+
+         fork_database_metrics            get_metrics()const;
+
          /**
           *  Given two head blocks, return two branches of the fork graph that
           *  end with a common ancestor (same prior block)
@@ -98,6 +156,11 @@ namespace sigmaengine { namespace chain {
          void _push_next(const item_ptr& newly_inserted);
 
          uint32_t                 _max_size = 1024;
+         uint32_t                 _irreversible_num = 0;
+         uint64_t                 _pruned_blocks = 0;
+         uint64_t                 _fork_switches = 0;
+         uint32_t                 _last_fork_switch_depth = 0;
+         uint32_t                 _max_fork_switch_depth = 0;
 
          fork_multi_index_type    _unlinked_index;
          fork_multi_index_type    _index;
@@ -105,3 +168,7 @@ namespace sigmaengine { namespace chain {
    };
 
 } } // sigmaengine::chain
+
+FC_REFLECT( sigmaengine::chain::fork_database_metrics,
+            (blocks)(unlinked_blocks)(unpacked_blocks)(packed_bytes)(fork_blocks)(fork_depth)
+            (irreversible_block_num)(pruned_blocks)(fork_switches)(last_fork_switch_depth)(max_fork_switch_depth) )
@@ -0,0 +1,154 @@
+#pragma once
+#include <sigmaengine/protocol/transaction.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/composite_key.hpp>
+
+#include <functional>
+#include <unordered_map>
+
+namespace sigmaengine { namespace chain {
+   using boost::multi_index_container;
+   using namespace boost::multi_index;
+
+   using sigmaengine::protocol::signed_transaction;
+   using sigmaengine::protocol::transaction_id_type;
+   using sigmaengine::protocol::account_name_type;
+   using sigmaengine::protocol::public_key_type;
+   using sigmaengine::protocol::signature_type;
+   using sigmaengine::protocol::chain_id_type;
+
+   /**
+    *  A transaction waiting in the pending queue, along with what the database
+    *  needs to know about it without packing or hashing it again.
+    */
+   struct pending_transaction
+   {
+      pending_transaction( const signed_transaction& t );
+
+      signed_transaction               trx;
+      transaction_id_type              id;
+      uint32_t                         packed_size = 0;
+      fc::time_point                   received;
+
+      /// the transaction and dapp fees charged when the transaction was applied to the pending state, set by the database
+      int64_t                          fee = 0;
+
+      /// the account paying for the transaction, the one required by its first operation
+      account_name_type                account;
+
+      /// block generation takes transactions with a higher priority first, set by the pool
+      int64_t                          priority = 0;
+   };
+
+   class transaction_pool;
+
+   /**
+    *  Scores a transaction as it enters the pool.  It is called before the
+    *  transaction is inserted, so the pool holds the transactions ahead of it.
+    */
+   typedef std::function< int64_t( const pending_transaction&, const transaction_pool& ) > pending_priority_type;
+
+   /**
+    *  The pending transactions of the database in arrival order.
+    *
+    *  The pool also remembers the keys recovered from the signatures of the
+    *  transactions it has seen, so a transaction that is re-applied after every
+    *  block, and finally applied as part of a block, only goes through public
+    *  key recovery once.  Keys are forgotten once their transaction leaves the
+    *  pool.
+    *
+    *  Block generation walks the pool by priority, ties going to the oldest
+    *  transaction.  The default priority is the age of the transaction.
+    */
+   class transaction_pool
+   {
+      public:
+         struct by_arrival;
+         struct by_trx_id;
+         struct by_priority;
+         struct by_account;
+         struct by_packed_size;
+         typedef multi_index_container<
+            pending_transaction,
+            indexed_by<
+               sequenced< tag< by_arrival > >,
+               hashed_unique< tag< by_trx_id >, member< pending_transaction, transaction_id_type, &pending_transaction::id >, std::hash< fc::ripemd160 > >,
+               ordered_non_unique< tag< by_priority >,
+                  composite_key< pending_transaction,
+                     member< pending_transaction, int64_t, &pending_transaction::priority >,
+                     member< pending_transaction, fc::time_point, &pending_transaction::received >
+                  >,
+                  composite_key_compare< std::greater< int64_t >, std::less< fc::time_point > >
+               >,
+               ordered_non_unique< tag< by_account >, member< pending_transaction, account_name_type, &pending_transaction::account > >,
+               ordered_non_unique< tag< by_packed_size >, member< pending_transaction, uint32_t, &pending_transaction::packed_size > >
+            >
+         > pending_multi_index_type;
+
+         typedef pending_multi_index_type::index< by_arrival >::type::const_iterator const_iterator;
+         typedef pending_multi_index_type::index< by_priority >::type priority_index_type;
+
+         /** Oldest first */
+         static int64_t age_priority( const pending_transaction& trx, const transaction_pool& pool );
+         /** Highest fee first, the fees the transaction was charged when it was applied to the pending state */
+         static int64_t fee_priority( const pending_transaction& trx, const transaction_pool& pool );
+         /** The first pending transaction of every account, then the second one of every account, and so on */
+         static int64_t account_fairness_priority( const pending_transaction& trx, const transaction_pool& pool );
+
+         /** Sets how transactions are prioritized and re-scores the pending ones */
+         void                             set_priority( pending_priority_type priority );
+
+         /** True when the priority is the age of the transactions, so arrival order is priority order */
+         bool                             keeps_arrival_order()const;
+
+         const pending_transaction&       push_back( pending_transaction&& trx );
+         bool                             contains( const transaction_id_type& id )const;
+         const pending_transaction*       find( const transaction_id_type& id )const;
+         /** Returns false if the transaction was not pending */
+         bool                             remove( const transaction_id_type& id );
+         void                             clear();
+
+         /** Removes every pending transaction and returns them oldest first, their signature keys stay cached */
+         vector< pending_transaction >    take();
+
+         const_iterator                   begin()const { return _transactions.get< by_arrival >().begin(); }
+         const_iterator                   end()const { return _transactions.get< by_arrival >().end(); }
+         size_t                           size()const { return _transactions.size(); }
+         bool                             empty()const { return _transactions.empty(); }
+
+         /** Pending transactions in the order block generation should consider them */
+         const priority_index_type&       prioritized()const { return _transactions.get< by_priority >(); }
+
+         /** Number of pending transactions paid for by account */
+         size_t                           count( const account_name_type& account )const;
+
+         /** Packed size of the smallest pending transaction, 0 when the pool is empty */
+         uint32_t                         min_packed_size()const;
+
+         /** The keys that signed trx, recovered from its signatures the first time they are asked for */
+         const flat_set< public_key_type >& signature_keys( const signed_transaction& trx, const transaction_id_type& id, const chain_id_type& chain_id );
+
+         /** The cached keys that signed trx, or nullptr if they were not recovered yet */
+         const flat_set< public_key_type >* find_signature_keys( const signed_transaction& trx, const transaction_id_type& id )const;
+
+         /** Forgets the signature keys of transactions that are no longer pending */
+         void                             prune_signature_keys();
+
+      private:
+         struct signature_keys_entry
+         {
+            vector< signature_type >      signatures;
+            flat_set< public_key_type >   keys;
+         };
+
+         pending_multi_index_type         _transactions;
+         pending_priority_type            _priority = &transaction_pool::age_priority;
+         std::unordered_map< transaction_id_type, signature_keys_entry, std::hash< fc::ripemd160 > > _signature_keys;
+   };
+
+} } // sigmaengine::chain
@@ -0,0 +1,152 @@
+#include <sigmaengine/chain/transaction_pool.hpp>
+
+#include <sigmaengine/protocol/operations.hpp>
+
+#include <fc/io/raw.hpp>
+
+namespace sigmaengine { namespace chain {
+
+pending_transaction::pending_transaction( const signed_transaction& t )
+   : trx( t ), id( t.id() ), packed_size( fc::raw::pack_size( t ) ), received( fc::time_point::now() )
+{
+   if( !trx.operations.empty() )
+   {
+      flat_set< account_name_type > first_active, first_owner, first_posting;
+      vector< protocol::authority > other;
+      operation_get_required_authorities( trx.operations.front(), first_active, first_owner, first_posting, other );
+      if( !first_active.empty() )
+         account = *first_active.begin();
+      else if( !first_owner.empty() )
+         account = *first_owner.begin();
+      else if( !first_posting.empty() )
+         account = *first_posting.begin();
+   }
+}
+
+int64_t transaction_pool::age_priority( const pending_transaction& trx, const transaction_pool& pool )
+{
+   return 0;
+}
+
+int64_t transaction_pool::fee_priority( const pending_transaction& trx, const transaction_pool& pool )
+{
+   return trx.fee;
+}
+
+int64_t transaction_pool::account_fairness_priority( const pending_transaction& trx, const transaction_pool& pool )
+{
+   return -int64_t( pool.count( trx.account ) );
+}
+
+void transaction_pool::set_priority( pending_priority_type priority )
+{
+   FC_ASSERT( priority, "A pending transaction priority is required" );
+   _priority = std::move( priority );
+
+   // scoring in arrival order lets a priority see the transactions that arrived before each one
+   auto pending = take();
+   for( auto& trx : pending )
+      push_back( std::move( trx ) );
+}
+
+bool transaction_pool::keeps_arrival_order()const
+{
+   typedef int64_t (*priority_function)( const pending_transaction&, const transaction_pool& );
+   const priority_function* f = _priority.target< priority_function >();
+   return f != nullptr && *f == &transaction_pool::age_priority;
+}
+
+const pending_transaction& transaction_pool::push_back( pending_transaction&& trx )
+{
+   trx.priority = _priority( trx, *this );
+   auto result = _transactions.get< by_arrival >().push_back( std::move( trx ) );
+   FC_ASSERT( result.second, "Transaction is already pending", ("id", result.first->id) );
+   return *result.first;
+}
+
+bool transaction_pool::contains( const transaction_id_type& id )const
+{
+   const auto& idx = _transactions.get< by_trx_id >();
+   return idx.find( id ) != idx.end();
+}
+
+const pending_transaction* transaction_pool::find( const transaction_id_type& id )const
+{
+   const auto& idx = _transactions.get< by_trx_id >();
+   auto itr = idx.find( id );
+   return itr == idx.end() ? nullptr : &*itr;
+}
+
+bool transaction_pool::remove( const transaction_id_type& id )
+{
+   auto& idx = _transactions.get< by_trx_id >();
+   auto itr = idx.find( id );
+   if( itr == idx.end() )
+      return false;
+   idx.erase( itr );
+   return true;
+}
+
+size_t transaction_pool::count( const account_name_type& account )const
+{
+   return _transactions.get< by_account >().count( account );
+}
+
+uint32_t transaction_pool::min_packed_size()const
+{
+   const auto& idx = _transactions.get< by_packed_size >();
+   return idx.empty() ? 0 : idx.begin()->packed_size;
+}
+
+void transaction_pool::clear()
+{
+   _transactions.clear();
+}
+
+vector< pending_transaction > transaction_pool::take()
+{
+   vector< pending_transaction > result;
+   result.reserve( _transactions.size() );
+
+   auto& idx = _transactions.get< by_arrival >();
+   while( !idx.empty() )
+   {
+      // the id, priority, received time, account and packed size are all keys, so the element is copied out rather than moved from while indexed
+      result.push_back( idx.front() );
+      idx.pop_front();
+   }
+   return result;
+}
+
+const flat_set< public_key_type >& transaction_pool::signature_keys( const signed_transaction& trx, const transaction_id_type& id, const chain_id_type& chain_id )
+{
+   auto itr = _signature_keys.find( id );
+   if( itr != _signature_keys.end() && itr->second.signatures == trx.signatures )
+      return itr->second.keys;
+
+   auto& entry = _signature_keys[ id ];
+   entry.keys = trx.get_signature_keys( chain_id );
+   entry.signatures = trx.signatures;
+   return entry.keys;
+}
+
+const flat_set< public_key_type >* transaction_pool::find_signature_keys( const signed_transaction& trx, const transaction_id_type& id )const
+{
+   auto itr = _signature_keys.find( id );
+   if( itr == _signature_keys.end() || itr->second.signatures != trx.signatures )
+      return nullptr;
+   return &itr->second.keys;
+}
+
+void transaction_pool::prune_signature_keys()
+{
+   for( auto itr = _signature_keys.begin(); itr != _signature_keys.end(); )
+   {
+      if( contains( itr->first ) )
+         ++itr;
+      else
+         itr = _signature_keys.erase( itr );
+   }
+}
+
+} } // sigmaengine::chain
@@ -37,6 +37,42 @@ namespace fc {
          fc::fwd<impl,96> my;
     };
 
+    /**
+     *  AES-256-GCM for a stream of authenticated records.  Each record is sealed
+     *  with the next value of a 96 bit counter nonce, so a key must never be shared
+     *  by two encoders.
+     */
+    class aes_gcm_encoder
+    {
+       public:
+         enum { tag_size = 16 };
+
+         aes_gcm_encoder();
+         ~aes_gcm_encoder();
+
+         void     init( const fc::sha256& key );
+         /** encrypts len bytes into ciphertxt, which may be the same buffer as plaintxt, and writes a tag_size byte tag */
+         uint32_t encode( const char* plaintxt, uint32_t len, char* ciphertxt, char* tag );
+
+       private:
+         struct      impl;
+         fc::fwd<impl,96> my;
+    };
+    class aes_gcm_decoder
+    {
+       public:
+         aes_gcm_decoder();
+         ~aes_gcm_decoder();
+
+         void     init( const fc::sha256& key );
+         /** decrypts len bytes into plaintext, which may be the same buffer as ciphertxt, throws if the tag does not match */
+         uint32_t decode( const char* ciphertxt, uint32_t len, const char* tag, char* plaintext );
+
+       private:
+         struct      impl;
+         fc::fwd<impl,96> my;
+    };
+
     unsigned aes_encrypt(unsigned char *plaintext, int plaintext_len, unsigned char *key,
                          unsigned char *iv, unsigned char *ciphertext);
     unsigned aes_decrypt(unsigned char *ciphertext, int ciphertext_len, unsigned char *key,
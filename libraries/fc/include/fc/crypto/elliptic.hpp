@@ -7,6 +7,9 @@
 #include <fc/array.hpp>
 #include <fc/io/raw_fwd.hpp>
 
+#include <utility>
+#include <vector>
+
 namespace fc {
 
   namespace ecc {
@@ -49,6 +52,13 @@ namespace fc {
            public_key( const public_key_point_data& v );
            public_key( const compact_signature& c, const fc::sha256& digest, bool check_canonical = true );
 
+           /**
+            * Recovers the keys of many (digest, signature) pairs in one call, in the order given.
+            * Large batches are spread over several threads.  Throws if any signature fails.
+            */
+           static std::vector< public_key > recover( const std::vector< std::pair< fc::sha256, compact_signature > >& signatures,
+                                                     bool check_canonical = true );
+
            public_key child( const fc::sha256& offset )const;
 
            bool valid()const;
@@ -6,6 +6,7 @@
 #include <memory>
 #include <vector>
 #include <functional>
+#include <typeinfo>
 #include <utility>
 #include <fc/signals.hpp>
 //#include <fc/rpc/json_connection.hpp>
@@ -248,6 +249,7 @@ namespace fc {
             if( itr != _handle_to_id.end() ) return itr->second;
 
             _local_apis.push_back( std::unique_ptr<generic_api>( new generic_api(a, shared_from_this() ) ) );
+            _local_api_types.push_back( typeid( Interface ).name() );
             _handle_to_id[handle] = _local_apis.size() - 1;
             return _local_apis.size() - 1;
          }
@@ -261,9 +263,17 @@ namespace fc {
 
          std::vector<std::string> get_method_names( api_id_type local_api_id = 0 )const { return _local_apis[local_api_id]->get_method_names(); }
 
+         /** Names the interface of a local api, the same on every connection it is registered with */
+         const std::string& get_api_type( api_id_type local_api_id )const
+         {
+            FC_ASSERT( _local_api_types.size() > local_api_id );
+            return _local_api_types[local_api_id];
+         }
+
          fc::signal<void()> closed;
       private:
          std::vector< std::unique_ptr<generic_api> >             _local_apis;
+         std::vector< std::string >                              _local_api_types;
          std::map< uint64_t, api_id_type >                       _handle_to_id;
          std::vector< std::function<variant(const variants&)>  > _local_callbacks;
 
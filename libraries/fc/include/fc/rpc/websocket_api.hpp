@@ -7,9 +7,41 @@
 
 namespace fc { namespace rpc {
 
+   /**
+    * Cache of serialized call results shared by websocket connections.  A call that the cache
+    * accepts is answered from the cache on a hit, and its serialized result is stored on a miss.
+    * Calls are only looked up once the api they target was resolved on the calling connection,
+    * so a connection is never answered for an api it was not granted.
+    */
+   class result_cache
+   {
+      public:
+         struct cached_call
+         {
+            std::string              key;
+            uint64_t                 generation = 0;
+            optional< std::string >  result;
+         };
+
+         virtual ~result_cache() {}
+
+         /**
+          * Returns false if the call must not be cached, otherwise fills in the key and, on a hit, the result.
+          * api is the type of the interface the method is called on, args are the arguments of the method.
+          */
+         virtual bool lookup( const std::string& api, const std::string& method, const variants& args, cached_call& call ) = 0;
+         virtual void store( const cached_call& call, const std::string& result ) = 0;
+   };
+
    class websocket_api_connection : public api_connection
    {
       public:
+         /**
+          * Consulted before an incoming call is executed.  It may throw to reject the call, in which case
+          * an error reply is sent without running it.  The returned token is held until the call completes.
+          */
+         typedef std::function< std::shared_ptr< void >( const std::string& method, const variants& params ) > admission_handler;
+
          websocket_api_connection( fc::http::websocket_connection& c );
          ~websocket_api_connection();
 
@@ -24,13 +56,24 @@ namespace fc { namespace rpc {
             uint64_t callback_id,
             variants args = variants() ) override;
 
+         void set_admission_handler( admission_handler h );
+         void set_result_cache( std::shared_ptr< result_cache > cache );
+
       protected:
          std::string on_message(
             const std::string& message,
             bool send_message = true );
 
+         /// The local api an api id or api name refers to, api names go through the login api
+         api_id_type resolve_api_id( const variant& api );
+
+         /// Result cache lookup of a call, once the api it targets is resolved on this connection
+         bool lookup_cached_call( const fc::rpc::request& call, result_cache::cached_call& cached );
+
          fc::http::websocket_connection&  _connection;
          fc::rpc::state                   _rpc_state;
+         admission_handler                _admission;
+         std::shared_ptr< result_cache >  _result_cache;
    };
 
 } } // namespace fc::rpc
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+namespace fc {
+
+  /**
+   *  Calls f( begin, end ) over consecutive ranges that together cover [0, count),
+   *  each holding at least min_per_thread items, and returns once all of them are done.
+   *
+   *  The ranges run on the calling thread and on a pool of worker threads that is
+   *  started on first use and shared by the process.  Ranges that no worker picks up
+   *  are run by the calling thread, so calling this from inside f cannot deadlock.
+   *  The first exception thrown by f is rethrown after every range has finished.
+   */
+  void parallel_for( size_t count, size_t min_per_thread, const std::function< void( size_t, size_t ) >& f );
+
+} // namespace fc
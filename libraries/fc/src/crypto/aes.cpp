@@ -161,6 +161,121 @@ uint32_t aes_decoder::final_decode( char* plaintext )
 }
 #endif
 
+struct aes_gcm_encoder::impl
+{
+   evp_cipher_ctx ctx;
+   uint64_t       counter = 0;
+};
+
+/** the 96 bit nonce for a record is its sequence number, zero extended */
+static void gcm_nonce( uint64_t counter, unsigned char* nonce )
+{
+    memset( nonce, 0, 12 );
+    for( int i = 0; i < 8; ++i )
+       nonce[4 + i] = (unsigned char)( counter >> ( 8 * i ) );
+}
+
+aes_gcm_encoder::aes_gcm_encoder()
+{
+  static int init = init_openssl();
+  FC_UNUSED(init);
+}
+
+aes_gcm_encoder::~aes_gcm_encoder()
+{
+}
+
+void aes_gcm_encoder::init( const fc::sha256& key )
+{
+    my->ctx.obj = EVP_CIPHER_CTX_new();
+    my->counter = 0;
+    if(!my->ctx)
+    {
+        FC_THROW_EXCEPTION( aes_exception, "error allocating evp cipher context",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    }
+
+    /* the key schedule is set up once, each record only supplies a new nonce */
+    if(1 != EVP_EncryptInit_ex(my->ctx, EVP_aes_256_gcm(), NULL, (unsigned char*)&key, NULL))
+    {
+        FC_THROW_EXCEPTION( aes_exception, "error during aes 256 gcm encryption init",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    }
+}
+
+uint32_t aes_gcm_encoder::encode( const char* plaintxt, uint32_t plaintext_len, char* ciphertxt, char* tag )
+{
+    unsigned char nonce[12];
+    gcm_nonce( my->counter++, nonce );
+
+    int ciphertext_len = 0;
+    int final_len = 0;
+    if(1 != EVP_EncryptInit_ex(my->ctx, NULL, NULL, NULL, nonce) ||
+       1 != EVP_EncryptUpdate(my->ctx, (unsigned char*)ciphertxt, &ciphertext_len, (const unsigned char*)plaintxt, plaintext_len) ||
+       1 != EVP_EncryptFinal_ex(my->ctx, (unsigned char*)ciphertxt + ciphertext_len, &final_len) ||
+       1 != EVP_CIPHER_CTX_ctrl(my->ctx, EVP_CTRL_GCM_GET_TAG, tag_size, tag))
+    {
+        FC_THROW_EXCEPTION( aes_exception, "error during aes 256 gcm encryption",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    }
+    FC_ASSERT( static_cast<uint32_t>(ciphertext_len + final_len) == plaintext_len, "", ("ciphertext_len",ciphertext_len + final_len)("plaintext_len",plaintext_len) );
+    return plaintext_len;
+}
+
+struct aes_gcm_decoder::impl
+{
+   evp_cipher_ctx ctx;
+   uint64_t       counter = 0;
+};
+
+aes_gcm_decoder::aes_gcm_decoder()
+{
+  static int init = init_openssl();
+  FC_UNUSED(init);
+}
+
+aes_gcm_decoder::~aes_gcm_decoder()
+{
+}
+
+void aes_gcm_decoder::init( const fc::sha256& key )
+{
+    my->ctx.obj = EVP_CIPHER_CTX_new();
+    my->counter = 0;
+    if(!my->ctx)
+    {
+        FC_THROW_EXCEPTION( aes_exception, "error allocating evp cipher context",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    }
+
+    if(1 != EVP_DecryptInit_ex(my->ctx, EVP_aes_256_gcm(), NULL, (unsigned char*)&key, NULL))
+    {
+        FC_THROW_EXCEPTION( aes_exception, "error during aes 256 gcm decryption init",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    }
+}
+
+uint32_t aes_gcm_decoder::decode( const char* ciphertxt, uint32_t ciphertxt_len, const char* tag, char* plaintext )
+{
+    unsigned char nonce[12];
+    gcm_nonce( my->counter++, nonce );
+
+    int plaintext_len = 0;
+    int final_len = 0;
+    if(1 != EVP_DecryptInit_ex(my->ctx, NULL, NULL, NULL, nonce) ||
+       1 != EVP_DecryptUpdate(my->ctx, (unsigned char*)plaintext, &plaintext_len, (const unsigned char*)ciphertxt, ciphertxt_len) ||
+       1 != EVP_CIPHER_CTX_ctrl(my->ctx, EVP_CTRL_GCM_SET_TAG, aes_gcm_encoder::tag_size, (void*)tag))
+    {
+        FC_THROW_EXCEPTION( aes_exception, "error during aes 256 gcm decryption",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    }
+    if(1 != EVP_DecryptFinal_ex(my->ctx, (unsigned char*)plaintext + plaintext_len, &final_len))
+    {
+        FC_THROW_EXCEPTION( aes_exception, "aes 256 gcm authentication failed" );
+    }
+    return plaintext_len + final_len;
+}
+
 
 
 
@@ -4,6 +4,7 @@
 #include <fc/crypto/hmac.hpp>
 #include <fc/crypto/openssl.hpp>
 #include <fc/crypto/ripemd160.hpp>
+#include <fc/thread/parallel.hpp>
 
 #ifdef _WIN32
 # include <malloc.h>
@@ -168,6 +169,21 @@ namespace fc { namespace ecc {
         return (fp[0] << 24) | (fp[1] << 16) | (fp[2] << 8) | fp[3];
     }
 
+    /** below this many signatures per thread a batch is recovered on the calling thread */
+    static const size_t recoveries_per_thread = 8;
+
+    std::vector< public_key > public_key::recover( const std::vector< std::pair< fc::sha256, compact_signature > >& signatures,
+                                                   bool check_canonical )
+    {
+        std::vector< public_key > result( signatures.size() );
+        fc::parallel_for( signatures.size(), recoveries_per_thread, [&]( size_t begin, size_t end )
+        {
+            for( size_t i = begin; i < end; ++i )
+                result[i] = public_key( signatures[i].second, signatures[i].first, check_canonical );
+        } );
+        return result;
+    }
+
     bool public_key::is_canonical( const compact_signature& c ) {
         return !(c.data[1] & 0x80)
                && !(c.data[1] == 0 && !(c.data[2] & 0x80))
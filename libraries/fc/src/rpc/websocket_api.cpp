@@ -13,19 +13,8 @@ websocket_api_connection::websocket_api_connection( fc::http::websocket_connecti
    _rpc_state.add_method( "call", [this]( const variants& args ) -> variant
    {
       FC_ASSERT( args.size() == 3 && args[2].is_array() );
-      api_id_type api_id;
-      if( args[0].is_string() )
-      {
-         variants subargs;
-         subargs.push_back( args[0] );
-         variant subresult = this->receive_call( 1, "get_api_by_name", subargs );
-         api_id = subresult.as_uint64();
-      }
-      else
-         api_id = args[0].as_uint64();
-
       return this->receive_call(
-         api_id,
+         resolve_api_id( args[0] ),
          args[1].as_string(),
          args[2].get_array() );
    } );
@@ -81,6 +70,50 @@ void websocket_api_connection::send_notice(
    _connection.send_message( fc::json::to_string(req) );
 }
 
+void websocket_api_connection::set_admission_handler( admission_handler h )
+{
+   _admission = std::move( h );
+}
+
+void websocket_api_connection::set_result_cache( std::shared_ptr< result_cache > cache )
+{
+   _result_cache = std::move( cache );
+}
+
+api_id_type websocket_api_connection::resolve_api_id( const variant& api )
+{
+   if( api.is_string() )
+   {
+      variants subargs;
+      subargs.push_back( api );
+      variant subresult = this->receive_call( 1, "get_api_by_name", subargs );
+      return subresult.as_uint64();
+   }
+   return api.as_uint64();
+}
+
+bool websocket_api_connection::lookup_cached_call( const fc::rpc::request& call, result_cache::cached_call& cached )
+{
+   if( call.method == "notice" || call.method == "callback" )
+      return false;
+
+   if( call.method == "call" )
+   {
+      if( call.params.size() != 3 || !call.params[1].is_string() || !call.params[2].is_array() )
+         return false;
+      const auto& api_type = get_api_type( resolve_api_id( call.params[0] ) );
+      return _result_cache->lookup( api_type, call.params[1].get_string(), call.params[2].get_array(), cached );
+   }
+
+   // methods called directly go to the first registered api, as they do in local_call
+   return _result_cache->lookup( get_api_type( 0 ), call.method, call.params, cached );
+}
+
+static std::string make_result_reply( int64_t id, const std::string& result_json )
+{
+   return "{\"id\":" + fc::json::to_string( id ) + ",\"result\":" + result_json + "}";
+}
+
 std::string websocket_api_connection::on_message(
    const std::string& message,
    bool send_message /* = true */ )
@@ -98,6 +131,20 @@ std::string websocket_api_connection::on_message(
          {
             try
             {
+               std::shared_ptr< void > admission_token;
+               if( _admission )
+                  admission_token = _admission( call.method, call.params );
+
+               result_cache::cached_call cached;
+               bool cacheable = call.id && _result_cache && lookup_cached_call( call, cached );
+               if( cacheable && cached.result.valid() )
+               {
+                  auto reply = make_result_reply( *call.id, *cached.result );
+                  if( send_message )
+                     _connection.send_message( reply );
+                  return reply;
+               }
+
 #ifdef LOG_LONG_API
                auto start = time_point::now();
 #endif
@@ -115,7 +162,16 @@ std::string websocket_api_connection::on_message(
 
                if( call.id )
                {
-                  auto reply = fc::json::to_string( response( *call.id, result ) );
+                  std::string reply;
+                  if( cacheable )
+                  {
+                     std::string result_json = fc::json::to_string( result );
+                     _result_cache->store( cached, result_json );
+                     reply = make_result_reply( *call.id, result_json );
+                  }
+                  else
+                     reply = fc::json::to_string( response( *call.id, result ) );
+
                   if( send_message )
                      _connection.send_message( reply );
                   return reply;
@@ -0,0 +1,160 @@
+#include <fc/thread/parallel.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fc {
+
+  namespace detail {
+
+    /** One parallel_for call, whose ranges are claimed by the caller and the workers */
+    class parallel_batch
+    {
+      public:
+        parallel_batch( size_t count, size_t chunk, const std::function< void( size_t, size_t ) >& f )
+        : _f( f ), _count( count ), _chunk( chunk ), _ranges( ( count + chunk - 1 ) / chunk ) {}
+
+        size_t ranges()const { return _ranges; }
+
+        /** Runs the next unclaimed range, returns false once every range was claimed */
+        bool run_one()
+        {
+          size_t r = _next++;
+          if( r >= _ranges )
+            return false;
+
+          std::exception_ptr error;
+          try
+          {
+            _f( r * _chunk, std::min( _count, ( r + 1 ) * _chunk ) );
+          }
+          catch( ... )
+          {
+            error = std::current_exception();
+          }
+
+          std::lock_guard< std::mutex > lock( _mutex );
+          if( error && !_error )
+            _error = error;
+          if( ++_done == _ranges )
+            _all_done.notify_all();
+          return true;
+        }
+
+        /** Waits for the ranges claimed by other threads and rethrows the first error */
+        void wait()
+        {
+          std::unique_lock< std::mutex > lock( _mutex );
+          _all_done.wait( lock, [this]() { return _done == _ranges; } );
+          if( _error )
+            std::rethrow_exception( _error );
+        }
+
+      private:
+        // only called for a claimed range, which the caller waits for, so the reference outlives every call
+        const std::function< void( size_t, size_t ) >&  _f;
+        const size_t                                    _count;
+        const size_t                                    _chunk;
+        const size_t                                    _ranges;
+        std::atomic< size_t >                           _next{ 0 };
+
+        std::mutex                                      _mutex;
+        std::condition_variable                         _all_done;
+        size_t                                          _done = 0;
+        std::exception_ptr                              _error;
+    };
+
+    /** Worker threads that help with parallel_for batches, one less than the hardware threads */
+    class worker_pool
+    {
+      public:
+        static worker_pool& instance()
+        {
+          static worker_pool pool;
+          return pool;
+        }
+
+        size_t size()const { return _threads.size(); }
+
+        void post( const std::shared_ptr< parallel_batch >& batch, size_t helpers )
+        {
+          {
+            std::lock_guard< std::mutex > lock( _mutex );
+            _queue.insert( _queue.end(), helpers, batch );
+          }
+          if( helpers == 1 )
+            _work.notify_one();
+          else
+            _work.notify_all();
+        }
+
+        ~worker_pool()
+        {
+          {
+            std::lock_guard< std::mutex > lock( _mutex );
+            _stopping = true;
+          }
+          _work.notify_all();
+          for( auto& t : _threads )
+            t.join();
+        }
+
+      private:
+        worker_pool()
+        {
+          size_t workers = std::max( 1u, std::thread::hardware_concurrency() ) - 1;
+          for( size_t i = 0; i < workers; ++i )
+            _threads.emplace_back( [this]() { run(); } );
+        }
+
+        void run()
+        {
+          while( true )
+          {
+            std::shared_ptr< parallel_batch > batch;
+            {
+              std::unique_lock< std::mutex > lock( _mutex );
+              _work.wait( lock, [this]() { return _stopping || !_queue.empty(); } );
+              if( _queue.empty() )
+                return;
+              batch = std::move( _queue.front() );
+              _queue.pop_front();
+            }
+            while( batch->run_one() );
+          }
+        }
+
+        std::mutex                                       _mutex;
+        std::condition_variable                          _work;
+        std::deque< std::shared_ptr< parallel_batch > >  _queue;
+        bool                                             _stopping = false;
+        std::vector< std::thread >                       _threads;
+    };
+
+  } // namespace detail
+
+  void parallel_for( size_t count, size_t min_per_thread, const std::function< void( size_t, size_t ) >& f )
+  {
+    auto& pool = detail::worker_pool::instance();
+    size_t threads = std::min( pool.size() + 1, count / std::max< size_t >( min_per_thread, 1 ) );
+    if( threads <= 1 )
+    {
+      if( count > 0 )
+        f( 0, count );
+      return;
+    }
+
+    auto batch = std::make_shared< detail::parallel_batch >( count, ( count + threads - 1 ) / threads, f );
+    pool.post( batch, batch->ranges() - 1 );
+    while( batch->run_one() );
+    batch->wait();
+  }
+
+} // namespace fc
@@ -37,6 +37,7 @@
 #include <fc/io/enum_type.hpp>
 
 
+#include <memory>
 #include <vector>
 
 namespace graphene { namespace net {
@@ -86,6 +87,7 @@ namespace graphene { namespace net {
     check_firewall_reply_message_type            = 5015,
     get_current_connections_request_message_type = 5016,
     get_current_connections_reply_message_type   = 5017,
+    authenticated_transport_message_type         = 5018,
     core_message_type_last                       = 5099
   };
 
@@ -113,6 +115,8 @@ namespace graphene { namespace net {
       signed_block    block;
       block_id_type   block_id;
 
+      /// the packed block as it was received, not part of the message
+      std::shared_ptr< const std::vector< char > > packed_block;
    };
 
   struct item_ids_inventory_message
@@ -398,6 +402,22 @@ namespace graphene { namespace net {
   };
 
 
+  /**
+   * Sent by each side once both hello messages advertise support for the
+   * authenticated transport.  Every record the sender writes after this
+   * message is sealed with the named AEAD cipher instead of AES-CBC; the
+   * message itself is consumed by message_oriented_connection and never
+   * reaches the node.
+   */
+  struct authenticated_transport_message
+  {
+    static const core_message_type_enum type;
+
+    std::string cipher;
+
+    authenticated_transport_message() : cipher("aes-256-gcm") {}
+  };
+
 } } // graphene::net
 
 FC_REFLECT_ENUM( graphene::net::core_message_type_enum,
@@ -421,6 +441,7 @@ FC_REFLECT_ENUM( graphene::net::core_message_type_enum,
                  (check_firewall_reply_message_type)
                  (get_current_connections_request_message_type)
                  (get_current_connections_reply_message_type)
+                 (authenticated_transport_message_type)
                  (core_message_type_last) )
 
 FC_REFLECT( graphene::net::trx_message, (trx) )
@@ -504,6 +525,7 @@ FC_REFLECT(graphene::net::get_current_connections_reply_message, (upload_rate_on
                                                             (upload_rate_one_hour)
                                                             (download_rate_one_hour)
                                                             (current_connections))
+FC_REFLECT(graphene::net::authenticated_transport_message, (cipher))
 
 #include <unordered_map>
 #include <fc/crypto/city.hpp>
@@ -204,6 +204,8 @@ namespace graphene { namespace net
       fc::optional<std::string> platform;
       fc::optional<uint32_t> bitness;
       fc::optional<sigmaengine::protocol::chain_id_type> chain_id;
+      /** true if the peer's hello advertised the AES-256-GCM authenticated transport */
+      bool             supports_authenticated_transport = false;
 
       // for inbound connections, these fields record what the peer sent us in
       // its hello message.  For outbound, they record what we sent the peer
@@ -26,11 +26,19 @@
 #include <fc/crypto/aes.hpp>
 #include <fc/crypto/elliptic.hpp>
 
+#include <vector>
+
 namespace graphene { namespace net {
 
 /**
  *  Uses ECDH to negotiate a aes key for communicating
  *  with other nodes on the network.
+ *
+ *  Traffic starts out as AES-256-CBC.  Once both peers have agreed on it, each
+ *  direction can be switched to AES-256-GCM records, which authenticate the data.
+ *  Each direction uses its own key.  A read that has room for a whole record
+ *  decrypts it in place in the caller's buffer, only partial reads go through
+ *  the record buffer.
  */
 class stcp_socket : public virtual fc::iostream
 {
@@ -56,8 +64,18 @@ class stcp_socket : public virtual fc::iostream
     using istream::get;
     void             get( char& c ) { read( &c, 1 ); }
     fc::sha512       get_shared_secret() const { return _shared_secret; }
+
+    /** every write after this call is sent as an authenticated record */
+    void             enable_authenticated_send();
+    /** every read after this call expects authenticated records */
+    void             enable_authenticated_receive();
   private:
     void do_key_exchange();
+    fc::sha256 authenticated_key( bool initiator_to_responder ) const;
+    uint32_t   read_record_length();
+    void       read_authenticated_record( uint32_t record_len );
+    char*      seal_record( const char* buffer, uint32_t len, char* record );
+    void       reserve_write_buffer( size_t len );
 
     fc::sha512           _shared_secret;
     fc::ecc::private_key _priv_key;
@@ -66,8 +84,17 @@ class stcp_socket : public virtual fc::iostream
     fc::tcp_socket       _sock;
     fc::aes_encoder      _send_aes;
     fc::aes_decoder      _recv_aes;
+    fc::aes_gcm_encoder  _send_gcm;
+    fc::aes_gcm_decoder  _recv_gcm;
+    bool                 _is_initiator = false;
+    bool                 _authenticated_send = false;
+    bool                 _authenticated_receive = false;
+    std::vector<char>    _record_buffer;   ///< plaintext of the last record received by a partial read
+    size_t               _record_offset = 0;
+    fc::array<char,fc::aes_gcm_encoder::tag_size> _record_tag;
     std::shared_ptr<char> _read_buffer;
     std::shared_ptr<char> _write_buffer;
+    size_t               _write_buffer_length = 0;
 #ifndef NDEBUG
     bool _read_buffer_in_use;
     bool _write_buffer_in_use;
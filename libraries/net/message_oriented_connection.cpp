@@ -30,6 +30,7 @@
 
 #include <graphene/net/message_oriented_connection.hpp>
 #include <graphene/net/stcp_socket.hpp>
+#include <graphene/net/core_messages.hpp>
 #include <graphene/net/config.hpp>
 
 #include <atomic>
@@ -174,6 +175,13 @@ namespace graphene { namespace net {
 
           _last_message_received_time = fc::time_point::now();
 
+          if (m.msg_type == core_message_type_enum::authenticated_transport_message_type)
+          {
+            // the peer seals everything after this marker, switch before reading the next header
+            _sock.enable_authenticated_receive();
+            continue;
+          }
+
           try
           {
             // message handling errors are warnings...
@@ -270,6 +278,8 @@ namespace graphene { namespace net {
 
         _sock.write(padded_message.get(), size_with_padding);
         _sock.flush();
+        if (message_to_send.msg_type == core_message_type_enum::authenticated_transport_message_type)
+          _sock.enable_authenticated_send();
         _bytes_sent += size_with_padding;
         _last_message_sent_time = fc::time_point::now();
       } FC_RETHROW_EXCEPTIONS( warn, "unable to send message" );
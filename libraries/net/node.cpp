@@ -441,6 +441,8 @@ namespace graphene { namespace net { namespace detail {
       active_sync_requests_map              _active_sync_requests; /// list of sync blocks we've asked for from peers but have not yet received
       std::list<graphene::net::block_message> _new_received_sync_items; /// list of sync blocks we've just received but haven't yet tried to process
       std::list<graphene::net::block_message> _received_sync_items; /// list of sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
+      typedef std::unordered_map<graphene::net::block_id_type, std::list<graphene::net::block_message>::iterator> received_sync_items_index;
+      received_sync_items_index             _received_sync_items_by_id; /// index of both lists above by block id, so lookups don't scan the whole prefetch window
       // @}
 
       fc::future<void> _process_backlog_of_sync_blocks_done;
@@ -985,10 +987,7 @@ namespace graphene { namespace net { namespace detail {
     bool node_impl::have_already_received_sync_item( const item_hash_t& item_hash )
     {
       VERIFY_CORRECT_THREAD();
-      return std::find_if(_received_sync_items.begin(), _received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _received_sync_items.end() ||
-             std::find_if(_new_received_sync_items.begin(), _new_received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _new_received_sync_items.end();                          ;
+      return _received_sync_items_by_id.find(item_hash) != _received_sync_items_by_id.end();
     }
 
     void node_impl::request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request )
@@ -1032,15 +1031,19 @@ namespace graphene { namespace net { namespace detail {
             ASSERT_TASK_NOT_PREEMPTED();
             std::set<item_hash_t> sync_items_to_request;
 
-            // for each idle peer that we're syncing with
+            // for each peer that we're syncing with and that has room in its request pipeline.  A peer becomes
+            // eligible again once half of its outstanding requests have arrived, so each peer always has a
+            // request in flight instead of sitting idle for a round trip between batches.
             for( const peer_connection_ptr& peer : _active_connections )
             {
               if( peer->we_need_sync_items_from_peer &&
                   sync_item_requests_to_send.find(peer) == sync_item_requests_to_send.end() && // if we've already scheduled a request for this peer, don't consider scheduling another
-                  peer->idle() )
+                  peer->items_requested_from_peer.empty() && !peer->item_ids_requested_from_peer &&
+                  peer->sync_items_requested_from_peer.size() <= _maximum_blocks_per_peer_during_syncing / 2 )
               {
                 if (!peer->inhibit_fetching_sync_blocks)
                 {
+                  size_t request_capacity = _maximum_blocks_per_peer_during_syncing - peer->sync_items_requested_from_peer.size();
                   // loop through the items it has that we don't yet have on our blockchain
                   for( unsigned i = 0; i < peer->ids_of_items_to_get.size(); ++i )
                   {
@@ -1053,7 +1056,7 @@ namespace graphene { namespace net { namespace detail {
                       // then schedule a request from this peer
                       sync_item_requests_to_send[peer].push_back(item_to_potentially_request);
                       sync_items_to_request.insert( item_to_potentially_request );
-                      if (sync_item_requests_to_send[peer].size() >= _maximum_blocks_per_peer_during_syncing)
+                      if (sync_item_requests_to_send[peer].size() >= request_capacity)
                         break;
                     }
                   }
@@ -1871,6 +1874,7 @@ namespace graphene { namespace net { namespace detail {
         user_data["last_known_fork_block_number"] = _hard_fork_block_numbers.back();
 
       user_data["chain_id"] = SIGMAENGINE_CHAIN_ID;
+      user_data["authenticated_transport"] = "aes-256-gcm";
 
       return user_data;
     }
@@ -1888,6 +1892,8 @@ namespace graphene { namespace net { namespace detail {
         originating_peer->last_known_fork_block_number = user_data["last_known_fork_block_number"].as<uint32_t>();
       if (user_data.contains("chain_id"))
         originating_peer->chain_id = user_data["chain_id"].as<sigmaengine::protocol::chain_id_type>();
+      if (user_data.contains("authenticated_transport"))
+        originating_peer->supports_authenticated_transport = user_data["authenticated_transport"].as_string() == "aes-256-gcm";
     }
 
     void node_impl::on_hello_message( peer_connection* originating_peer, const hello_message& hello_message_received )
@@ -1940,6 +1946,12 @@ namespace graphene { namespace net { namespace detail {
           disconnect_from_peer( originating_peer, "Invalid signature in hello message" );
           return;
         }
+        if (originating_peer->supports_authenticated_transport)
+        {
+          // both sides advertised it, so everything we send after this marker is sealed with AES-256-GCM.
+          // The peer makes the same decision independently for its own direction.
+          originating_peer->send_message(message(authenticated_transport_message()));
+        }
         if (originating_peer->last_known_fork_block_number != 0)
         {
           uint32_t next_fork_block_number = get_next_known_hard_fork_block_number(originating_peer->last_known_fork_block_number);
@@ -3267,84 +3279,89 @@ namespace graphene { namespace net { namespace detail {
 
       do
       {
-        std::copy(std::make_move_iterator(_new_received_sync_items.begin()),
-                  std::make_move_iterator(_new_received_sync_items.end()),
-                  std::front_inserter(_received_sync_items));
-        _new_received_sync_items.clear();
+        _received_sync_items.splice(_received_sync_items.begin(), _new_received_sync_items);
         dlog("currently ${count} sync items to consider", ("count", _received_sync_items.size()));
 
         block_processed_this_iteration = false;
-        for (auto received_block_iter = _received_sync_items.begin();
-             received_block_iter != _received_sync_items.end();
-             ++received_block_iter)
+
+        // the only blocks we can push are the ones at the front of some sync peer's list of items to get,
+        // so look those up in the index instead of scanning every block in the prefetch window
+        auto received_block_iter = _received_sync_items.end();
+        for (const peer_connection_ptr& peer : _active_connections)
         {
+          ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+          if (peer->ids_of_items_to_get.empty())
+            continue;
+          auto index_iter = _received_sync_items_by_id.find(peer->ids_of_items_to_get.front());
+          if (index_iter != _received_sync_items_by_id.end())
+          {
+            received_block_iter = index_iter->second;
+            break;
+          }
+        }
 
-          // find out if this block is the next block on the active chain or one of the forks
-          bool potential_first_block = false;
+        // if there is one, process it, remove it from all sync peers lists
+        if (received_block_iter != _received_sync_items.end())
+        {
           for (const peer_connection_ptr& peer : _active_connections)
           {
             ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
             if (!peer->ids_of_items_to_get.empty() &&
                 peer->ids_of_items_to_get.front() == received_block_iter->block_id)
             {
-              potential_first_block = true;
               peer->ids_of_items_to_get.pop_front();
               peer->ids_of_items_being_processed.insert(received_block_iter->block_id);
             }
           }
 
-          // if it is, process it, remove it from all sync peers lists
-          if (potential_first_block)
+          // we can get into an interesting situation near the end of synchronization.  We can be in
+          // sync with one peer who is sending us the last block on the chain via a regular inventory
+          // message, while at the same time still be synchronizing with a peer who is sending us the
+          // block through the sync mechanism.  Further, we must request both blocks because
+          // we don't know they're the same (for the peer in normal operation, it has only told us the
+          // message id, for the peer in the sync case we only known the block_id).
+          if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
+                        received_block_iter->block_id) == _most_recent_blocks_accepted.end())
           {
-            // we can get into an interesting situation near the end of synchronization.  We can be in
-            // sync with one peer who is sending us the last block on the chain via a regular inventory
-            // message, while at the same time still be synchronizing with a peer who is sending us the
-            // block through the sync mechanism.  Further, we must request both blocks because
-            // we don't know they're the same (for the peer in normal operation, it has only told us the
-            // message id, for the peer in the sync case we only known the block_id).
-            if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
-                          received_block_iter->block_id) == _most_recent_blocks_accepted.end())
-            {
-              graphene::net::block_message block_message_to_process = *received_block_iter;
-              _received_sync_items.erase(received_block_iter);
-              _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
-                send_sync_block_to_node_delegate(block_message_to_process);
-              }, "send_sync_block_to_node_delegate"));
-              ++blocks_processed;
-              block_processed_this_iteration = true;
-            }
-            else
+            graphene::net::block_message block_message_to_process = *received_block_iter;
+            _received_sync_items_by_id.erase(received_block_iter->block_id);
+            _received_sync_items.erase(received_block_iter);
+            _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
+              send_sync_block_to_node_delegate(block_message_to_process);
+            }, "send_sync_block_to_node_delegate"));
+            ++blocks_processed;
+            block_processed_this_iteration = true;
+          }
+          else
+          {
+            dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
+            std::vector< peer_connection_ptr > peers_needing_next_batch;
+            for (const peer_connection_ptr& peer : _active_connections)
             {
-              dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
-              std::vector< peer_connection_ptr > peers_needing_next_batch;
-              for (const peer_connection_ptr& peer : _active_connections)
+              auto items_being_processed_iter = peer->ids_of_items_being_processed.find(received_block_iter->block_id);
+              if (items_being_processed_iter != peer->ids_of_items_being_processed.end())
               {
-                auto items_being_processed_iter = peer->ids_of_items_being_processed.find(received_block_iter->block_id);
-                if (items_being_processed_iter != peer->ids_of_items_being_processed.end())
+                peer->ids_of_items_being_processed.erase(items_being_processed_iter);
+                dlog("Removed item from ${endpoint}'s list of items being processed, still processing ${len} blocks",
+                     ("endpoint", peer->get_remote_endpoint())("len", peer->ids_of_items_being_processed.size()));
+
+                // if we just processed the last item in our list from this peer, we will want to
+                // send another request to find out if we are now in sync (this is normally handled in
+                // send_sync_block_to_node_delegate)
+                if (peer->ids_of_items_to_get.empty() &&
+                    peer->number_of_unfetched_item_ids == 0 &&
+                    peer->ids_of_items_being_processed.empty())
                 {
-                  peer->ids_of_items_being_processed.erase(items_being_processed_iter);
-                  dlog("Removed item from ${endpoint}'s list of items being processed, still processing ${len} blocks",
-                       ("endpoint", peer->get_remote_endpoint())("len", peer->ids_of_items_being_processed.size()));
-
-                  // if we just processed the last item in our list from this peer, we will want to
-                  // send another request to find out if we are now in sync (this is normally handled in
-                  // send_sync_block_to_node_delegate)
-                  if (peer->ids_of_items_to_get.empty() &&
-                      peer->number_of_unfetched_item_ids == 0 &&
-                      peer->ids_of_items_being_processed.empty())
-                  {
-                    dlog("We received last item in our list for peer ${endpoint}, setup to do a sync check", ("endpoint", peer->get_remote_endpoint()));
-                    peers_needing_next_batch.push_back( peer );
-                  }
+                  dlog("We received last item in our list for peer ${endpoint}, setup to do a sync check", ("endpoint", peer->get_remote_endpoint()));
+                  peers_needing_next_batch.push_back( peer );
                 }
               }
-              for( const peer_connection_ptr& peer : peers_needing_next_batch )
-                fetch_next_batch_of_item_ids_from_peer(peer.get());
             }
+            for( const peer_connection_ptr& peer : peers_needing_next_batch )
+              fetch_next_batch_of_item_ids_from_peer(peer.get());
+          }
 
-            break; // start iterating _received_sync_items from the beginning
-          } // end if potential_first_block
-        } // end for each block in _received_sync_items
+        } // end if there is a block we can push
 
         if (_handle_message_calls_in_progress.size() >= _maximum_number_of_blocks_to_handle_at_one_time)
         {
@@ -3377,9 +3394,17 @@ namespace graphene { namespace net { namespace detail {
       VERIFY_CORRECT_THREAD();
       dlog( "received a sync block from peer ${endpoint}", ("endpoint", originating_peer->get_remote_endpoint() ) );
 
+      // the same block can arrive from more than one peer near the end of synchronization
+      if (have_already_received_sync_item(block_message_to_process.block_id))
+      {
+        dlog( "already have sync block ${id}, ignoring the duplicate", ("id", block_message_to_process.block_id) );
+        return;
+      }
+
       // add it to the front of _received_sync_items, then process _received_sync_items to try to
       // pass as many messages as possible to the client.
       _new_received_sync_items.push_front( block_message_to_process );
+      _received_sync_items_by_id[block_message_to_process.block_id] = _new_received_sync_items.begin();
       trigger_process_backlog_of_sync_blocks();
     }
 
@@ -3550,6 +3575,11 @@ namespace graphene { namespace net { namespace detail {
       // mode before we receive and process the item.  In that case, we should process the item as a normal
       // item to avoid confusing the sync code)
       graphene::net::block_message block_message_to_process(message_to_process.as<graphene::net::block_message>());
+      // the message is the packed block followed by its id, so the chain does not have to pack the block again
+      size_t packed_id_size = fc::raw::pack_size( block_message_to_process.block_id );
+      if( message_to_process.data.size() > packed_id_size )
+        block_message_to_process.packed_block = std::make_shared< const std::vector< char > >(
+          message_to_process.data.begin(), message_to_process.data.end() - packed_id_size );
       auto item_iter = originating_peer->items_requested_from_peer.find(item_id(graphene::net::block_message_type, message_hash));
       if (item_iter != originating_peer->items_requested_from_peer.end())
       {
@@ -3584,6 +3614,8 @@ namespace graphene { namespace net { namespace detail {
               else
                 trigger_fetch_sync_items_loop();
             }
+            else if (originating_peer->sync_items_requested_from_peer.size() == _maximum_blocks_per_peer_during_syncing / 2)
+              trigger_fetch_sync_items_loop(); // room in this peer's pipeline for the next batch
             return;
           }
           catch (const fc::canceled_exception& e)
@@ -32,6 +32,7 @@
 #include <fc/network/ip.hpp>
 #include <fc/exception/exception.hpp>
 
+#include <graphene/net/config.hpp>
 #include <graphene/net/stcp_socket.hpp>
 
 namespace graphene { namespace net {
@@ -72,9 +73,74 @@ void stcp_socket::do_key_exchange()
 void stcp_socket::connect_to( const fc::ip::endpoint& remote_endpoint )
 {
   _sock.connect_to( remote_endpoint );
+  _is_initiator = true;
   do_key_exchange();
 }
 
+fc::sha256 stcp_socket::authenticated_key( bool initiator_to_responder ) const
+{
+  // the gcm nonces are per-direction counters, so the two directions must never share a key
+  fc::sha256::encoder enc;
+  enc.write( (const char*)&_shared_secret, sizeof(_shared_secret) );
+  const char* label = initiator_to_responder ? "initiator-to-responder" : "responder-to-initiator";
+  enc.write( label, strlen(label) );
+  return enc.result();
+}
+
+void stcp_socket::enable_authenticated_send()
+{
+  _send_gcm.init( authenticated_key( _is_initiator ) );
+  _authenticated_send = true;
+}
+
+void stcp_socket::enable_authenticated_receive()
+{
+  _recv_gcm.init( authenticated_key( !_is_initiator ) );
+  _authenticated_receive = true;
+}
+
+uint32_t stcp_socket::read_record_length()
+{
+  uint32_t record_len = 0;
+  _sock.read( (char*)&record_len, sizeof(record_len) );
+  FC_ASSERT( record_len > 0 && record_len % 16 == 0 && record_len <= MAX_MESSAGE_SIZE + 16,
+             "invalid authenticated record length", ("len", record_len) );
+  return record_len;
+}
+
+/**
+ *  Reads the [ciphertext][tag] of a record and decrypts it in place into
+ *  _record_buffer, which keeps its capacity from one record to the next.
+ */
+void stcp_socket::read_authenticated_record( uint32_t record_len )
+{
+  _record_buffer.resize( record_len + fc::aes_gcm_encoder::tag_size );
+  _sock.read( _record_buffer.data(), _record_buffer.size() );
+  _recv_gcm.decode( _record_buffer.data(), record_len, _record_buffer.data() + record_len, _record_buffer.data() );
+  _record_buffer.resize( record_len );
+  _record_offset = 0;
+}
+
+/**
+ *  Encrypts len bytes of buffer into a [length][ciphertext][tag] record
+ *  starting at record and returns the end of the record.
+ */
+char* stcp_socket::seal_record( const char* buffer, uint32_t len, char* record )
+{
+  memcpy( record, (char*)&len, sizeof(len) );
+  record += sizeof(len);
+  _send_gcm.encode( buffer, len, record, record + len );
+  return record + len + fc::aes_gcm_encoder::tag_size;
+}
+
+void stcp_socket::reserve_write_buffer( size_t len )
+{
+  if( _write_buffer_length >= len )
+    return;
+  _write_buffer.reset(new char[len], [](char* p){ delete[] p; });
+  _write_buffer_length = len;
+}
+
 void stcp_socket::bind( const fc::ip::endpoint& local_endpoint )
 {
   _sock.bind(local_endpoint);
@@ -100,6 +166,28 @@ size_t stcp_socket::readsome( char* buffer, size_t len )
     } buffer_in_use_checker(_read_buffer_in_use);
 #endif
 
+    if( _authenticated_receive )
+    {
+      if( _record_offset == _record_buffer.size() )
+      {
+        uint32_t record_len = read_record_length();
+        if( len >= record_len )
+        {
+          // the whole record fits, so it is decrypted where the caller wants it
+          _sock.read( buffer, record_len );
+          _sock.read( _record_tag.data, fc::aes_gcm_encoder::tag_size );
+          _recv_gcm.decode( buffer, record_len, _record_tag.data, buffer );
+          return record_len;
+        }
+        read_authenticated_record( record_len );
+      }
+
+      size_t s = std::min( len, _record_buffer.size() - _record_offset );
+      memcpy( buffer, _record_buffer.data() + _record_offset, s );
+      _record_offset += s;
+      return s;
+    }
+
     const size_t read_buffer_length = 4096;
     if (!_read_buffer)
       _read_buffer.reset(new char[read_buffer_length], [](char* p){ delete[] p; });
@@ -141,9 +229,29 @@ size_t stcp_socket::writesome( const char* buffer, size_t len )
     } buffer_in_use_checker(_write_buffer_in_use);
 #endif
 
+    if( _authenticated_send )
+    {
+      // messages are read back as their first cipher block, which holds the header, and then
+      // the rest, so sealing those as two records lets both reads decrypt in place
+      const uint32_t first_record_len = 16;
+      const size_t record_overhead = sizeof(uint32_t) + fc::aes_gcm_encoder::tag_size;
+      reserve_write_buffer( len + 2 * record_overhead );
+
+      char* end = _write_buffer.get();
+      if( len > first_record_len )
+      {
+        end = seal_record( buffer, first_record_len, end );
+        end = seal_record( buffer + first_record_len, len - first_record_len, end );
+      }
+      else
+        end = seal_record( buffer, len, end );
+
+      _sock.write( _write_buffer, end - _write_buffer.get() );
+      return len;
+    }
+
     const std::size_t write_buffer_length = 4096;
-    if (!_write_buffer)
-      _write_buffer.reset(new char[write_buffer_length], [](char* p){ delete[] p; });
+    reserve_write_buffer( write_buffer_length );
     len = std::min<size_t>(write_buffer_length, len);
     memset(_write_buffer.get(), 0, len); // just in case aes.encode screws up
     /**
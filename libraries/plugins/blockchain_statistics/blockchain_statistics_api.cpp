@@ -14,17 +14,27 @@ namespace detail
          statistics get_stats_for_interval( fc::time_point_sec start, fc::time_point_sec end )const;
          statistics get_lifetime_stats()const;
 
+         const blockchain_statistics_plugin& plugin()const;
+
          sigmaengine::app::application& _app;
    };
 
+   const blockchain_statistics_plugin& blockchain_statistics_api_impl::plugin()const
+   {
+      return *_app.get_plugin< blockchain_statistics_plugin >( BLOCKCHAIN_STATISTICS_PLUGIN_NAME );
+   }
+
    statistics blockchain_statistics_api_impl::get_stats_for_time( fc::time_point_sec open, uint32_t interval )const
    {
       statistics result;
-      const auto& bucket_idx = _app.chain_database()->get_index< bucket_index >().indices().get< by_bucket >();
-      auto itr = bucket_idx.lower_bound( boost::make_tuple( interval, open ) );
+      if( interval == 0 )
+         return result;
+
+      open = fc::time_point_sec( ( open.sec_since_epoch() / interval ) * interval );
+      auto buckets = plugin().get_buckets( interval, open, 1 );
 
-      if( itr != bucket_idx.end() )
-         result += *itr;
+      if( !buckets.empty() && buckets.front().open == open )
+         result += buckets.front();
 
       return result;
    }
@@ -32,8 +42,8 @@ namespace detail
    statistics blockchain_statistics_api_impl::get_stats_for_interval( fc::time_point_sec start, fc::time_point_sec end )const
    {
       statistics result;
-      const auto& bucket_itr = _app.chain_database()->get_index< bucket_index >().indices().get< by_bucket >();
-      const auto& sizes = _app.get_plugin< blockchain_statistics_plugin >( BLOCKCHAIN_STATISTICS_PLUGIN_NAME )->get_tracked_buckets();
+      const auto& stats = plugin();
+      const auto& sizes = stats.get_tracked_buckets();
       auto size_itr = sizes.rbegin();
       auto time = start;
 
@@ -42,13 +52,15 @@ namespace detail
       // has the same efficiency as the dynamic solution.
       while( size_itr != sizes.rend() && time < end )
       {
-         auto itr = bucket_itr.find( boost::make_tuple( *size_itr, time ) );
+         auto buckets = stats.get_buckets( *size_itr, time, ( end.sec_since_epoch() - time.sec_since_epoch() ) / *size_itr );
 
-         while( itr != bucket_itr.end() && itr->seconds == *size_itr && time + itr->seconds <= end )
+         for( const auto& b : buckets )
          {
+            if( b.open != time )
+               break;
+
             time += *size_itr;
-            result += *itr;
-            itr++;
+            result += b;
          }
 
          size_itr++;
@@ -60,7 +72,7 @@ namespace detail
    statistics blockchain_statistics_api_impl::get_lifetime_stats()const
    {
       statistics result;
-      result += _app.chain_database()->get( bucket_id_type() );
+      result += plugin().get_lifetime_stats();
 
       return result;
    }
@@ -75,29 +87,20 @@ void blockchain_statistics_api::on_api_startup() {}
 
 statistics blockchain_statistics_api::get_stats_for_time( fc::time_point_sec open, uint32_t interval )const
 {
-   return my->_app.chain_database()->with_read_lock( [&]()
-   {
-      return my->get_stats_for_time( open, interval );
-   });
+   return my->get_stats_for_time( open, interval );
 }
 
 statistics blockchain_statistics_api::get_stats_for_interval( fc::time_point_sec start, fc::time_point_sec end )const
 {
-   return my->_app.chain_database()->with_read_lock( [&]()
-   {
-      return my->get_stats_for_interval( start, end );
-   });
+   return my->get_stats_for_interval( start, end );
 }
 
 statistics blockchain_statistics_api::get_lifetime_stats()const
 {
-   return my->_app.chain_database()->with_read_lock( [&]()
-   {
-      return my->get_lifetime_stats();
-   });
+   return my->get_lifetime_stats();
 }
 
-statistics& statistics::operator +=( const bucket_object& b )
+statistics& statistics::operator +=( const bucket_stats& b )
 {
    this->blocks                                 += b.blocks;
    this->bandwidth                              += b.bandwidth;
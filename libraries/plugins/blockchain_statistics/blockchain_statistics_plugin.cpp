@@ -5,14 +5,52 @@
 #include <sigmaengine/chain/history_object.hpp>
 
 #include <sigmaengine/chain/database.hpp>
-#include <sigmaengine/chain/index.hpp>
 #include <sigmaengine/chain/operation_notification.hpp>
 
+#include <fc/io/fstream.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <tuple>
+
+#include <sys/stat.h>
+
 namespace sigmaengine { namespace blockchain_statistics {
 
 namespace detail
 {
 
+/// statistics of a single applied block that may still be undone by a fork switch
+struct block_stats
+{
+   uint32_t             block_num = 0;
+   fc::time_point_sec   timestamp;
+   bucket_stats         stats;
+};
+
+/**
+ * What is written to the statistics file, buckets of each size are ordered by open time.
+ * The buckets only count irreversible blocks.  The reversible blocks are written next to
+ * them for read only nodes, the writing node drops them on load as the chain state is
+ * rewound to the last irreversible block on open.
+ */
+struct statistics_snapshot
+{
+   uint32_t                                                 last_block_num = 0;
+   bucket_stats                                             lifetime;
+   flat_map< uint32_t, std::deque< bucket_stats > >         buckets;
+   std::deque< block_stats >                                reversible;
+};
+
+} } } // sigmaengine::blockchain_statistics::detail
+
+FC_REFLECT( sigmaengine::blockchain_statistics::detail::block_stats, (block_num)(timestamp)(stats) )
+FC_REFLECT( sigmaengine::blockchain_statistics::detail::statistics_snapshot, (last_block_num)(lifetime)(buckets)(reversible) )
+
+namespace sigmaengine { namespace blockchain_statistics { namespace detail {
+
 using namespace sigmaengine::protocol;
 
 class blockchain_statistics_plugin_impl
@@ -23,22 +61,41 @@ class blockchain_statistics_plugin_impl
       virtual ~blockchain_statistics_plugin_impl() {}
 
       void on_block( const signed_block& b );
-      void post_operation( const operation_notification& o );
+      block_stats get_block_stats( const signed_block& b )const;
+      void reconcile( uint32_t head );
+
+      void fold( const block_stats& s );
+      void roll_up( const bucket_stats& closed );
+      void prune( std::deque< bucket_stats >& ring, uint32_t seconds, fc::time_point_sec now );
+
+      void load();
+      void save();
+      void refresh();
 
       blockchain_statistics_plugin&       _self;
       flat_set< uint32_t >                _tracked_buckets = { 60, 3600, 21600, 86400, 604800, 2592000 };
-      flat_set< bucket_id_type >   _current_buckets;
       uint32_t                            _maximum_history_per_bucket_size = 100;
+      fc::path                            _stats_file;
+      bool                                _read_only = false;
+      bool                                _reconciled = false;
+
+      /**
+       * Only the smallest bucket size is fed block by block, its buckets are rolled up into
+       * the larger sizes once they close.  Blocks above the last irreversible block are kept
+       * in _state.reversible, oldest first.
+       */
+      statistics_snapshot                 _state;
+      mutable std::mutex                  _mutex;
+
+      /// inode, size and modification time of the statistics file a read only node loaded last
+      std::tuple< ino_t, off_t, time_t, long > _file_version;
 };
 
 struct operation_process
 {
-   const blockchain_statistics_plugin& _plugin;
-   const bucket_object&                _bucket;
-   chain::database&                    _db;
+   bucket_stats& _stats;
 
-   operation_process( blockchain_statistics_plugin& bsp, const bucket_object& b )
-      :_plugin( bsp ), _bucket( b ), _db( bsp.database() ) {}
+   operation_process( bucket_stats& s ) : _stats( s ) {}
 
    typedef void result_type;
 
@@ -47,138 +104,263 @@ struct operation_process
 
    void operator()( const transfer_operation& op )const
    {
-      _db.modify( _bucket, [&]( bucket_object& b )
-      {
-         b.transfers++;
+      _stats.transfers++;
 
-         if( op.amount.symbol == SGT_SYMBOL )
-            b.pia_transferred += op.amount.amount;
-      });
+      if( op.amount.symbol == SGT_SYMBOL )
+         _stats.pia_transferred += op.amount.amount;
    }
 
    void operator()( const account_create_operation& op )const
    {
-      _db.modify( _bucket, [&]( bucket_object& b )
-      {
-         b.accounts_created++;
-      });
+      _stats.accounts_created++;
    }
 
 };
 
-void blockchain_statistics_plugin_impl::on_block( const signed_block& b )
+/// every counter comes from the block itself, so blocks can also be counted from the block log
+block_stats blockchain_statistics_plugin_impl::get_block_stats( const signed_block& b )const
 {
+   block_stats result;
+   result.block_num = b.block_num();
+   result.timestamp = b.timestamp;
+   result.stats.blocks = 1;
+   result.stats.transactions = b.transactions.size();
+
+   for( const auto& trx : b.transactions )
+   {
+      result.stats.bandwidth += fc::raw::pack_size( trx );
+      result.stats.operations += trx.operations.size();
+      for( const auto& op : trx.operations )
+         op.visit( operation_process( result.stats ) );
+   }
+
+   return result;
+}
+
+/**
+ * Brings the statistics in line with the chain the node starts from.  Irreversible blocks the file
+ * is missing, after a crash or with a new file, are counted from the block log, and statistics of
+ * blocks the chain does not have are counted again from the start.
+ */
+void blockchain_statistics_plugin_impl::reconcile( uint32_t head )
+{
+   if( _reconciled )
+      return;
+   _reconciled = true;
+
    auto& db = _self.database();
+   uint32_t last_irreversible = std::min( db.get_dynamic_global_properties().last_irreversible_block_num, head );
 
-   if( b.block_num() == 1 )
+   std::lock_guard< std::mutex > lock( _mutex );
+   if( _state.last_block_num > last_irreversible )
    {
-      db.create< bucket_object >( [&]( bucket_object& bo )
-      {
-         bo.open = b.timestamp;
-         bo.seconds = 0;
-         bo.blocks = 1;
-      });
+      wlog( "Chain statistics of ${f} count blocks up to ${b}, the last irreversible block is ${l}, counting them again",
+            ("f", _stats_file)("b", _state.last_block_num)("l", last_irreversible) );
+      for( auto& ring : _state.buckets )
+         ring.second.clear();
+      _state.last_block_num = 0;
+      _state.lifetime = bucket_stats();
+   }
+
+   if( _state.last_block_num < last_irreversible )
+      ilog( "Counting chain statistics of blocks ${f} to ${t}", ("f", _state.last_block_num + 1)("t", last_irreversible) );
+
+   _state.reversible.clear();
+   for( uint32_t block_num = _state.last_block_num + 1; block_num <= head; ++block_num )
+   {
+      auto b = db.fetch_block_by_number( block_num );
+      FC_ASSERT( b.valid(), "Block ${b} is missing", ("b", block_num) );
+
+      if( block_num <= last_irreversible )
+         fold( get_block_stats( *b ) );
+      else
+         _state.reversible.push_back( get_block_stats( *b ) );
    }
-   else
+}
+
+void blockchain_statistics_plugin_impl::on_block( const signed_block& b )
+{
+   auto& db = _self.database();
+
+   // blocks may be applied before the plugin starts up
+   reconcile( b.block_num() - 1 );
+
+   auto current = get_block_stats( b );
+   uint32_t last_irreversible = db.get_dynamic_global_properties().last_irreversible_block_num;
+
    {
-      db.modify( db.get( bucket_id_type() ), [&]( bucket_object& bo )
+      std::lock_guard< std::mutex > lock( _mutex );
+      auto& reversible = _state.reversible;
+
+      // a block we already saw at this height was popped by a fork switch
+      while( !reversible.empty() && reversible.back().block_num >= current.block_num )
+         reversible.pop_back();
+      reversible.push_back( current );
+
+      while( !reversible.empty() && reversible.front().block_num <= last_irreversible )
       {
-         bo.blocks++;
-      });
+         fold( reversible.front() );
+         reversible.pop_front();
+      }
    }
 
-   _current_buckets.clear();
-   _current_buckets.insert( bucket_id_type() );
-
-   const auto& bucket_idx = db.get_index< bucket_index >().indices().get< by_bucket >();
+   // read only nodes serve the statistics from the file, so it follows every block but the ones
+   // replayed from the block log, plugin_startup saves those
+   if( !( db.get_node_properties().skip_flags & database::skip_block_log ) )
+      save();
+}
 
-   uint32_t trx_size = 0;
-   uint32_t num_trx =b.transactions.size();
+void blockchain_statistics_plugin_impl::fold( const block_stats& s )
+{
+   auto smallest = _state.buckets.begin()->first;
+   auto& ring = _state.buckets.begin()->second;
+   auto open = fc::time_point_sec( ( s.timestamp.sec_since_epoch() / smallest ) * smallest );
 
-   for( auto trx : b.transactions )
+   if( ring.empty() || ring.back().open != open )
    {
-      trx_size += fc::raw::pack_size( trx );
+      if( !ring.empty() )
+         roll_up( ring.back() );
+
+      ring.emplace_back();
+      ring.back().open = open;
+      ring.back().seconds = smallest;
+      prune( ring, smallest, s.timestamp );
    }
 
+   ring.back() += s.stats;
+   _state.lifetime += s.stats;
+   _state.last_block_num = s.block_num;
+}
 
-   for( auto bucket : _tracked_buckets )
+void blockchain_statistics_plugin_impl::roll_up( const bucket_stats& closed )
+{
+   for( auto itr = _state.buckets.begin() + 1; itr != _state.buckets.end(); ++itr )
    {
-      auto open = fc::time_point_sec( ( db.head_block_time().sec_since_epoch() / bucket ) * bucket );
-      auto itr = bucket_idx.find( boost::make_tuple( bucket, open ) );
+      auto seconds = itr->first;
+      auto& ring = itr->second;
+      auto open = fc::time_point_sec( ( closed.open.sec_since_epoch() / seconds ) * seconds );
 
-      if( itr == bucket_idx.end() )
+      if( ring.empty() || ring.back().open != open )
       {
-         _current_buckets.insert(
-            db.create< bucket_object >( [&]( bucket_object& bo )
-            {
-               bo.open = open;
-               bo.seconds = bucket;
-               bo.blocks = 1;
-            }).id );
-
-         if( _maximum_history_per_bucket_size > 0 )
-         {
-            try
-            {
-               auto cutoff = fc::time_point_sec( ( safe< uint32_t >( db.head_block_time().sec_since_epoch() ) - safe< uint32_t >( bucket ) * safe< uint32_t >( _maximum_history_per_bucket_size ) ).value );
-
-               itr = bucket_idx.lower_bound( boost::make_tuple( bucket, fc::time_point_sec() ) );
-
-               while( itr->seconds == bucket && itr->open < cutoff )
-               {
-                  auto old_itr = itr;
-                  ++itr;
-                  db.remove( *old_itr );
-               }
-            }
-            catch( fc::overflow_exception& e ) {}
-            catch( fc::underflow_exception& e ) {}
-         }
+         ring.emplace_back();
+         ring.back().open = open;
+         ring.back().seconds = seconds;
+         prune( ring, seconds, closed.open );
       }
-      else
-      {
-         db.modify( *itr, [&]( bucket_object& bo )
-         {
-            bo.blocks++;
-         });
 
-         _current_buckets.insert( itr->id );
-      }
-
-      db.modify( *itr, [&]( bucket_object& bo )
-      {
-         bo.transactions += num_trx;
-         bo.bandwidth += trx_size;
-      });
+      ring.back() += closed;
    }
 }
 
+void blockchain_statistics_plugin_impl::prune( std::deque< bucket_stats >& ring, uint32_t seconds, fc::time_point_sec now )
+{
+   if( _maximum_history_per_bucket_size == 0 )
+      return;
+
+   uint64_t history = uint64_t( seconds ) * _maximum_history_per_bucket_size;
+   if( history >= now.sec_since_epoch() )
+      return;
 
+   auto cutoff = fc::time_point_sec( now.sec_since_epoch() - history );
+   while( !ring.empty() && ring.front().open < cutoff )
+      ring.pop_front();
+}
 
-void blockchain_statistics_plugin_impl::post_operation( const operation_notification& o )
+void blockchain_statistics_plugin_impl::load()
 {
+   if( !fc::exists( _stats_file ) )
+      return;
+
    try
    {
-   auto& db = _self.database();
+      std::string data;
+      fc::read_file_contents( _stats_file, data );
+      auto saved = fc::raw::unpack< statistics_snapshot >( std::vector< char >( data.begin(), data.end() ) );
+
+      _state.last_block_num = saved.last_block_num;
+      _state.lifetime = saved.lifetime;
+      for( auto& ring : _state.buckets )
+      {
+         auto itr = saved.buckets.find( ring.first );
+         if( itr != saved.buckets.end() )
+            ring.second = std::move( itr->second );
+         else
+            ring.second.clear();
+      }
+      if( _read_only )
+         _state.reversible = std::move( saved.reversible );
+      else
+         _state.reversible.clear();
 
-   for( auto bucket_id : _current_buckets )
+      if( !_read_only )
+         ilog( "Loaded chain statistics up to block ${b} from ${f}", ("b", _state.last_block_num)("f", _stats_file) );
+   }
+   catch( const fc::exception& e )
    {
-      const auto& bucket = db.get(bucket_id);
+      wlog( "Unable to load chain statistics from ${f}, starting over: ${e}", ("f", _stats_file)("e", e.to_detail_string()) );
+      for( auto& ring : _state.buckets )
+         ring.second.clear();
+      _state.last_block_num = 0;
+      _state.lifetime = bucket_stats();
+      _state.reversible.clear();
+   }
+}
+
+/// loads the statistics file again once the writing node replaced it, called with _mutex held
+void blockchain_statistics_plugin_impl::refresh()
+{
+   struct stat st;
+   if( ::stat( _stats_file.generic_string().c_str(), &st ) != 0 )
+      return;
+
+   auto version = std::make_tuple( st.st_ino, st.st_size, st.st_mtim.tv_sec, st.st_mtim.tv_nsec );
+   if( version == _file_version )
+      return;
 
-      if( !is_virtual_operation( o.op ) )
+   _file_version = version;
+   load();
+}
+
+void blockchain_statistics_plugin_impl::save()
+{
+   try
+   {
+      std::vector< char > data;
+      {
+         std::lock_guard< std::mutex > lock( _mutex );
+         data = fc::raw::pack( _state );
+      }
+
+      // write a temporary file first so a crash never leaves a truncated statistics file behind
+      fc::path tmp = _stats_file.generic_string() + ".tmp";
       {
-         db.modify( bucket, [&]( bucket_object& b )
-         {
-            b.operations++;
-         });
+         std::ofstream out( tmp.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+         out.write( data.data(), data.size() );
+         FC_ASSERT( out, "Unable to write chain statistics to ${f}", ("f", tmp) );
       }
-      o.op.visit( operation_process( _self, bucket ) );
+      fc::rename( tmp, _stats_file );
+   }
+   catch( const fc::exception& e )
+   {
+      elog( "Unable to save chain statistics: ${e}", ("e", e.to_detail_string()) );
    }
-   } FC_CAPTURE_AND_RETHROW()
 }
 
 } // detail
 
+bucket_stats& bucket_stats::operator +=( const bucket_stats& b )
+{
+   this->blocks                                 += b.blocks;
+   this->bandwidth                              += b.bandwidth;
+   this->operations                             += b.operations;
+   this->transactions                           += b.transactions;
+   this->transfers                              += b.transfers;
+   this->pia_transferred                        += b.pia_transferred;
+   this->accounts_created                       += b.accounts_created;
+
+   return ( *this );
+}
+
 blockchain_statistics_plugin::blockchain_statistics_plugin( application* app )
    :plugin( app ), _my( new detail::blockchain_statistics_plugin_impl( *this ) ) {}
 
@@ -194,6 +376,8 @@ void blockchain_statistics_plugin::plugin_set_program_options(
            "Track blockchain statistics by grouping orders into buckets of equal size measured in seconds specified as a JSON array of numbers")
          ("chain-stats-history-per-bucket", boost::program_options::value<uint32_t>()->default_value(100),
            "How far back in time to track history for each bucket size, measured in the number of buckets (default: 100)")
+         ("chain-stats-file", boost::program_options::value<string>(),
+           "File the blockchain statistics are saved to. Defaults to chain_stats.bin next to the shared memory file")
          ;
    cfg.add(cli);
 }
@@ -205,10 +389,10 @@ void blockchain_statistics_plugin::plugin_initialize( const boost::program_optio
       ilog( "chain_stats_plugin: plugin_initialize() begin" );
       chain::database& db = database();
 
-      db.applied_block.connect( [&]( const signed_block& b ){ _my->on_block( b ); } );
-      db.post_apply_operation.connect( [&]( const operation_notification& o ){ _my->post_operation( o ); } );
-
-      add_plugin_index< bucket_index >(db);
+      // a read only node serves the statistics the writing node saves
+      _my->_read_only = options.count( "read-only" ) > 0;
+      if( !_my->_read_only )
+         db.applied_block.connect( [&]( const signed_block& b ){ _my->on_block( b ); } );
 
       if( options.count( "chain-stats-bucket-size" ) )
       {
@@ -218,6 +402,40 @@ void blockchain_statistics_plugin::plugin_initialize( const boost::program_optio
       if( options.count( "chain-stats-history-per-bucket" ) )
          _my->_maximum_history_per_bucket_size = options[ "chain-stats-history-per-bucket" ].as< uint32_t >();
 
+      // larger buckets are rolled up from the smallest one, so they have to be multiples of it
+      FC_ASSERT( !_my->_tracked_buckets.empty() && *_my->_tracked_buckets.begin() > 0, "chain-stats-bucket-size must contain a positive bucket size" );
+      for( auto bucket : _my->_tracked_buckets )
+      {
+         FC_ASSERT( bucket % *_my->_tracked_buckets.begin() == 0,
+            "Bucket size ${b} is not a multiple of the smallest bucket size ${s}", ("b", bucket)("s", *_my->_tracked_buckets.begin()) );
+         _my->_state.buckets[ bucket ];
+      }
+
+      if( options.count( "chain-stats-file" ) )
+         _my->_stats_file = fc::path( options.at( "chain-stats-file" ).as< string >() );
+      else
+      {
+         fc::path shared_dir;
+         if( options.count( "shared-file-dir" ) )
+            shared_dir = fc::path( options.at( "shared-file-dir" ).as< string >() );
+         else if( options.count( "data-dir" ) )
+            shared_dir = fc::path( options.at( "data-dir" ).as< boost::filesystem::path >() ) / "blockchain";
+         else
+            shared_dir = fc::path( "blockchain" );
+         _my->_stats_file = shared_dir / "chain_stats.bin";
+      }
+      if( _my->_read_only )
+      {
+         std::lock_guard< std::mutex > lock( _my->_mutex );
+         _my->refresh();
+      }
+      else
+      {
+         if( !fc::exists( _my->_stats_file.parent_path() ) )
+            fc::create_directories( _my->_stats_file.parent_path() );
+         _my->load();
+      }
+
       wlog( "chain-stats-bucket-size: ${b}", ("b", _my->_tracked_buckets) );
       wlog( "chain-stats-history-per-bucket: ${h}", ("h", _my->_maximum_history_per_bucket_size) );
 
@@ -229,11 +447,27 @@ void blockchain_statistics_plugin::plugin_startup()
 {
    ilog( "chain_stats plugin: plugin_startup() begin" );
 
+   if( !_my->_read_only )
+   {
+      // blocks are applied under the write lock, so none is counted while the statistics catch up
+      database().with_read_lock( [&]()
+      {
+         _my->reconcile( database().head_block_num() );
+      });
+      _my->save();
+   }
+
    app().register_api_factory< blockchain_statistics_api >( "chain_stats_api" );
 
    ilog( "chain_stats plugin: plugin_startup() end" );
 }
 
+void blockchain_statistics_plugin::plugin_shutdown()
+{
+   if( !_my->_read_only )
+      _my->save();
+}
+
 const flat_set< uint32_t >& blockchain_statistics_plugin::get_tracked_buckets() const
 {
    return _my->_tracked_buckets;
@@ -244,6 +478,66 @@ uint32_t blockchain_statistics_plugin::get_max_history_per_bucket() const
    return _my->_maximum_history_per_bucket_size;
 }
 
+vector< bucket_stats > blockchain_statistics_plugin::get_buckets( uint32_t seconds, fc::time_point_sec start, uint32_t limit ) const
+{
+   vector< bucket_stats > result;
+   std::lock_guard< std::mutex > lock( _my->_mutex );
+   if( _my->_read_only )
+      _my->refresh();
+
+   auto ring_itr = _my->_state.buckets.find( seconds );
+   if( ring_itr == _my->_state.buckets.end() || limit == 0 )
+      return result;
+
+   const auto& ring = ring_itr->second;
+   auto itr = std::lower_bound( ring.begin(), ring.end(), start,
+      []( const bucket_stats& b, fc::time_point_sec t ){ return b.open < t; } );
+   for( ; itr != ring.end() && result.size() < limit; ++itr )
+      result.push_back( *itr );
+
+   // adds statistics not rolled up into this size yet, they are always at the newest end
+   auto add = [&]( fc::time_point_sec time, const bucket_stats& stats )
+   {
+      auto open = fc::time_point_sec( ( time.sec_since_epoch() / seconds ) * seconds );
+      if( open < start )
+         return;
+
+      auto pos = std::lower_bound( result.begin(), result.end(), open,
+         []( const bucket_stats& b, fc::time_point_sec t ){ return b.open < t; } );
+      if( pos == result.end() || pos->open != open )
+      {
+         pos = result.insert( pos, bucket_stats() );
+         pos->open = open;
+         pos->seconds = seconds;
+      }
+      *pos += stats;
+   };
+
+   const auto& smallest = *_my->_state.buckets.begin();
+   if( seconds != smallest.first && !smallest.second.empty() )
+      add( smallest.second.back().open, smallest.second.back() );
+   for( const auto& s : _my->_state.reversible )
+      add( s.timestamp, s.stats );
+
+   if( result.size() > limit )
+      result.resize( limit );
+
+   return result;
+}
+
+bucket_stats blockchain_statistics_plugin::get_lifetime_stats() const
+{
+   std::lock_guard< std::mutex > lock( _my->_mutex );
+   if( _my->_read_only )
+      _my->refresh();
+   bucket_stats result = _my->_state.lifetime;
+
+   for( const auto& s : _my->_state.reversible )
+      result += s.stats;
+
+   return result;
+}
+
 } } // sigmaengine::blockchain_statistics
 
 SIGMAENGINE_DEFINE_PLUGIN( blockchain_statistics, sigmaengine::blockchain_statistics::blockchain_statistics_plugin );
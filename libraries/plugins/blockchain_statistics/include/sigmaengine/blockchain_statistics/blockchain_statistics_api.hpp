@@ -25,7 +25,7 @@ struct statistics
    share_type           pia_transferred = 0;                         ///< PIA transferred from account to account
    uint32_t             accounts_created = 0;                        ///< Total accounts created
 
-   statistics& operator += ( const bucket_object& b );
+   statistics& operator += ( const bucket_stats& b );
 };
 
 class blockchain_statistics_api
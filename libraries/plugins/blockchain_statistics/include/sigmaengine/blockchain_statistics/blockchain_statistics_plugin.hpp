@@ -2,7 +2,7 @@
 #include <sigmaengine/app/plugin.hpp>
 #include <sigmaengine/chain/sigmaengine_object_types.hpp>
 
-#include <boost/multi_index/composite_key.hpp>
+#include <fc/container/flat.hpp>
 
 #ifndef BLOCKCHAIN_STATISTICS_PLUGIN_NAME
 #define BLOCKCHAIN_STATISTICS_PLUGIN_NAME "chain_stats"
@@ -13,16 +13,31 @@ namespace sigmaengine { namespace blockchain_statistics {
 using namespace sigmaengine::chain;
 using app::application;
 
-enum blockchain_statistics_object_type
-{
-   bucket_object_type = ( BLOCKCHAIN_STATISTICS_SPACE_ID << 8 )
-};
-
 namespace detail
 {
    class blockchain_statistics_plugin_impl;
 }
 
+/**
+ * Aggregated statistics of all blocks whose timestamp falls in [open, open + seconds).
+ * Buckets are kept in memory by the plugin and never touch the shared memory file.
+ */
+struct bucket_stats
+{
+   fc::time_point_sec   open;                                        ///< Open time of the bucket
+   uint32_t             seconds = 0;                                 ///< Seconds accounted for in the bucket
+   uint32_t             blocks = 0;                                  ///< Blocks produced
+   uint32_t             bandwidth = 0;                               ///< Bandwidth in bytes
+   uint32_t             operations = 0;                              ///< Operations evaluated
+   uint32_t             transactions = 0;                            ///< Transactions processed
+   uint32_t             transfers = 0;                               ///< Account to account transfers
+   share_type           pia_transferred = 0;                         ///< PIA transferred from account to account
+   uint32_t             accounts_created = 0;
+
+   /// adds the counters of b, open and seconds are left untouched
+   bucket_stats& operator += ( const bucket_stats& b );
+};
+
 class blockchain_statistics_plugin : public sigmaengine::app::plugin
 {
    public:
@@ -35,58 +50,26 @@ class blockchain_statistics_plugin : public sigmaengine::app::plugin
          boost::program_options::options_description& cfg ) override;
       virtual void plugin_initialize( const boost::program_options::variables_map& options ) override;
       virtual void plugin_startup() override;
+      virtual void plugin_shutdown() override;
 
       const flat_set< uint32_t >& get_tracked_buckets() const;
       uint32_t get_max_history_per_bucket() const;
 
+      /**
+       * Returns up to limit buckets of the given size opened at or after start, oldest first.
+       * Buckets of reversible blocks are included.
+       */
+      vector< bucket_stats > get_buckets( uint32_t seconds, fc::time_point_sec start, uint32_t limit ) const;
+      bucket_stats get_lifetime_stats() const;
+
    private:
       friend class detail::blockchain_statistics_plugin_impl;
       std::unique_ptr< detail::blockchain_statistics_plugin_impl > _my;
 };
 
-struct bucket_object : public object< bucket_object_type, bucket_object >
-{
-   template< typename Constructor, typename Allocator >
-   bucket_object( Constructor&& c, allocator< Allocator > a )
-   {
-      c( *this );
-   }
-
-   id_type              id;
-
-   fc::time_point_sec   open;                                        ///< Open time of the bucket
-   uint32_t             seconds = 0;                                 ///< Seconds accounted for in the bucket
-   uint32_t             blocks = 0;                                  ///< Blocks produced
-   uint32_t             bandwidth = 0;                               ///< Bandwidth in bytes
-   uint32_t             operations = 0;                              ///< Operations evaluated
-   uint32_t             transactions = 0;                            ///< Transactions processed
-   uint32_t             transfers = 0;                               ///< Account to account transfers
-   share_type           pia_transferred = 0;                         ///< PIA transferred from account to account
-   uint32_t             accounts_created = 0; 
-};
-
-typedef oid< bucket_object > bucket_id_type;
-
-struct by_id;
-struct by_bucket;
-typedef multi_index_container<
-   bucket_object,
-   indexed_by<
-      ordered_unique< tag< by_id >, member< bucket_object, bucket_id_type, &bucket_object::id > >,
-      ordered_unique< tag< by_bucket >,
-         composite_key< bucket_object,
-            member< bucket_object, uint32_t, &bucket_object::seconds >,
-            member< bucket_object, fc::time_point_sec, &bucket_object::open >
-         >
-      >
-   >,
-   allocator< bucket_object >
-> bucket_index;
-
 } } // sigmaengine::blockchain_statistics
 
-FC_REFLECT( sigmaengine::blockchain_statistics::bucket_object,
-   (id)
+FC_REFLECT( sigmaengine::blockchain_statistics::bucket_stats,
    (open)
    (seconds)
    (blocks)
@@ -97,4 +80,3 @@ FC_REFLECT( sigmaengine::blockchain_statistics::bucket_object,
    (pia_transferred)
    (accounts_created)
 )
-CHAINBASE_SET_INDEX_TYPE( sigmaengine::blockchain_statistics::bucket_object, sigmaengine::blockchain_statistics::bucket_index )
@@ -345,6 +345,7 @@ void bobserver_plugin::plugin_set_program_options(
          ("bobserver,b", bpo::value<vector<string>>()->composing()->multitoken(),
           ("name of bobserver controlled by this node (e.g. " + bobserver_id_example+" )" ).c_str())
          ("private-key", bpo::value<vector<string>>()->composing()->multitoken(), "WIF PRIVATE KEY to be used by one or more bobservers or miners" )
+         ("pending-transaction-priority", bpo::value<string>()->default_value("age"), "Order pending transactions are included in produced blocks: age, fee (the transaction and dapp fees charged) or account (round robin over the paying accounts). Only age lets the next block be assembled as transactions arrive, the others order the pending transactions again when a block is produced" )
          ;
    config_file_options.add(command_line_options);
 }
@@ -376,6 +377,17 @@ void bobserver_plugin::plugin_initialize(const boost::program_options::variables
 
    chain::database& db = database();
 
+   if( options.count("pending-transaction-priority") )
+   {
+      const string priority = options["pending-transaction-priority"].as<string>();
+      if( priority == "fee" )
+         db.set_pending_transaction_priority( &chain::transaction_pool::fee_priority );
+      else if( priority == "account" )
+         db.set_pending_transaction_priority( &chain::transaction_pool::account_fairness_priority );
+      else
+         FC_ASSERT( priority == "age", "Unknown pending transaction priority ${p}", ("p", priority) );
+   }
+
    db.post_apply_operation.connect( [&]( const operation_notification& note ){ _my->post_operation( note ); } );
    db.pre_apply_block.connect( [&]( const signed_block& b ){ _my->pre_apply_block( b ); } );
    db.pre_apply_operation.connect( [&]( const operation_notification& note ){ _my->pre_operation( note ); } );
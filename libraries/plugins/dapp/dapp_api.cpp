@@ -1,6 +1,8 @@
 #include <sigmaengine/dapp/dapp_api.hpp>
+#include <sigmaengine/dapp/dapp_plugin.hpp>
 #include <sigmaengine/app/state.hpp>
 
+#include <cstring>
 #include <functional>
 
 namespace sigmaengine { namespace dapp {
@@ -9,7 +11,8 @@ namespace sigmaengine { namespace dapp {
       class dapp_api_impl
       {
          public:
-            dapp_api_impl( sigmaengine::app::application& app ):_app( app ) {}
+            dapp_api_impl( sigmaengine::app::application& app )
+               :_app( app ), _content( app.get_plugin< dapp_plugin >( DAPP_PLUGIN_NAME )->content_store() ) {}
 
             vector< dapp_api_object > lookup_dapps( string& lower_bound_name, uint32_t limit ) const;
             optional< dapp_api_object > get_dapp( string dapp_name ) const;
@@ -25,14 +28,20 @@ namespace sigmaengine { namespace dapp {
             vector< dapp_discussion > get_dapp_replies_by_last_update( 
                      string dapp_name, account_name_type account, account_name_type start_author, string start_permlink, uint32_t limit )const;
             dapp_discussion get_dapp_discussion( dapp_comment_id_type id, uint32_t truncate_body )const;
+            void load_content( dapp_discussion& d, const dapp_comment_object& o, uint32_t truncate_body = 0 )const;
+
+            vector< dapp_discussion_summary > get_dapp_feed_by_created( string dapp_name, string start_author, string start_permlink, uint32_t limit )const;
+            vector< dapp_discussion_summary > get_dapp_feed_by_trending( string dapp_name, string start_author, string start_permlink, uint32_t limit )const;
+            vector< dapp_discussion_summary > get_dapp_feed_by_author( string dapp_name, string author, string start_permlink, uint32_t limit )const;
+
+            template< typename Index >
+            typename Index::const_iterator feed_begin( const Index& feed_idx, typename Index::const_iterator itr,
+                                                       const string& dapp_name, const string& start_author, const string& start_permlink )const;
+            template< typename Index >
+            vector< dapp_discussion_summary > get_dapp_feed( const Index& feed_idx, typename Index::const_iterator itr, uint32_t limit,
+                                                             const std::function< bool( const dapp_feed_object& ) >& in_feed )const;
+            vector< dapp_comment_vote_api_object > get_comment_votes( dapp_comment_id_type comment, comment_vote_type type )const;
 
-            template<typename Index, typename StartItr>
-            vector< dapp_discussion > get_dapp_discussions( const dapp_discussion_query& query, 
-                                                   const Index& comment_idx, StartItr comment_itr,
-                                                   const std::function< bool( const dapp_comment_api_obj& ) >& filter,
-                                                   const std::function< bool( const dapp_comment_api_obj& ) >& exit,
-                                                   bool ignore_parent = false
-                                                )const;
             vector< dapp_user_api_object > lookup_dapp_users( string dapp_name, string lower_bound_name, uint32_t limit )const;
             vector< dapp_user_api_object > get_join_dapps( string account_name )const;
             vector< dapp_vote_api_object > get_dapp_votes( string dapp_name ) const;
@@ -45,12 +54,14 @@ namespace sigmaengine { namespace dapp {
             vector <dapp_nsta602_owner_api_object> get_nsta602_by_owner( string owner, uint32_t from, uint32_t limit, bool newest ) const;
             vector <dapp_nsta602_api_object> get_nsta602_by_author( string author, uint32_t from, uint32_t limit, bool newest ) const;
 
+            template< typename Index, typename Key >
+            static typename Index::const_iterator nth_in_range( const Index& idx, const Key& key, uint32_t from );
+
             sigmaengine::chain::database& database() { return *_app.chain_database(); }
 
          private:
-            static bool filter_default( const dapp_comment_api_obj& c ) { return false; }
-            static bool exit_default( const dapp_comment_api_obj& c )   { return false; }
             sigmaengine::app::application& _app;
+            const dapp_content_store& _content;
       };
 
       vector< dapp_api_object > dapp_api_impl::lookup_dapps( string& lower_bound_name, uint32_t limit ) const
@@ -102,8 +113,9 @@ namespace sigmaengine { namespace dapp {
             if( itr != by_permlink_idx.end() )
             {
                optional< dapp_discussion > result( *itr);
-               result->like_votes = get_dapp_active_votes( dapp_name, author, permlink, comment_vote_type::LIKE );
-               result->dislike_votes = get_dapp_active_votes( dapp_name, author, permlink, comment_vote_type::DISLIKE );
+               load_content( *result, *itr );
+               result->like_votes = get_comment_votes( itr->id, comment_vote_type::LIKE );
+               result->dislike_votes = get_comment_votes( itr->id, comment_vote_type::DISLIKE );
                return result;
             }
             return {};
@@ -119,9 +131,11 @@ namespace sigmaengine { namespace dapp {
             const auto& by_permlink_idx = _app.chain_database()->get_index< dapp_comment_index >().indices().get< by_parent >();
             auto itr = by_permlink_idx.find( boost::make_tuple( dapp_name, acc_name, permlink ) );
             vector<dapp_discussion> result;
-            while( itr != by_permlink_idx.end() && itr->dapp_name == dapp_name && itr->parent_author == author && to_string( itr->parent_permlink ) == permlink )
+            while( itr != by_permlink_idx.end() && itr->dapp_name == dapp_name && itr->parent_author == author
+                  && std::strcmp( itr->parent_permlink.c_str(), permlink.c_str() ) == 0 )
             {
                result.push_back( dapp_discussion( *itr ) );
+               load_content( result.back(), *itr );
                ++itr;
             }
             return result;
@@ -134,119 +148,127 @@ namespace sigmaengine { namespace dapp {
          auto& _db = *(_app.chain_database());
          // const auto& dapp_comment_idx = _app.chain_database()->get_index< dapp_comment_index >().indices().get< by_id >();
          // dapp_discussion d = dapp_comment_idx.get(id);
-         dapp_discussion d = _db.get(id);
-
-         d.like_votes = get_dapp_active_votes( d.dapp_name, d.author, d.permlink, comment_vote_type::LIKE );
-         d.dislike_votes = get_dapp_active_votes( d.dapp_name, d.author, d.permlink, comment_vote_type::DISLIKE );
-         d.body_length = d.body.size();
-         if( truncate_body ) {
-            d.body = d.body.substr( 0, truncate_body );
+         const auto& o = _db.get(id);
+         dapp_discussion d = o;
 
-            if( !fc::is_utf8( d.body ) )
-               d.body = fc::prune_invalid_utf8( d.body );
-         }
+         d.like_votes = get_comment_votes( o.id, comment_vote_type::LIKE );
+         d.dislike_votes = get_comment_votes( o.id, comment_vote_type::DISLIKE );
+         load_content( d, o, truncate_body );
          return d;
       }
 
-      template<typename Index, typename StartItr>
-      vector< dapp_discussion > dapp_api_impl::get_dapp_discussions( const dapp_discussion_query& query,
-                                                      const Index& comment_idx, StartItr comment_itr,
-                                                      const std::function< bool( const dapp_comment_api_obj& ) >& filter,
-                                                      const std::function< bool( const dapp_comment_api_obj& ) >& exit,
-                                                      bool ignore_parent
-                                                      )const
+      void dapp_api_impl::load_content( dapp_discussion& d, const dapp_comment_object& o, uint32_t truncate_body )const
       {
-         auto& _db = *(_app.chain_database());
-
-         vector< dapp_discussion > result;
-#ifndef IS_LOW_MEM
-         query.validate();
-         auto dapp_name = query.dapp_name;
-         auto start_author = query.start_author ? *( query.start_author ) : "";
-         auto start_permlink = query.start_permlink ? *( query.start_permlink ) : "";
-         auto parent_author = query.parent_author ? *( query.parent_author ) : "";
-
-         const auto &permlink_idx = _db.get_index< dapp_comment_index >().indices().get< by_permlink >();
-
-         dlog("get_dapp_discussions : dapp = ${dapp}, start_author = ${author}, start_permlink = ${permlink}, parent_author = ${parent}"
-            , ( "dapp", dapp_name )( "author", start_author )( "permlink", start_permlink )( "parent", parent_author ) );
+         d.title = _content.load( o.title );
+         d.json_metadata = _content.load( o.json_metadata );
+         d.body_length = o.body.size;
+         // only the requested prefix of the body is read from the store
+         d.body = _content.load( o.body, truncate_body );
+         if( truncate_body && !fc::is_utf8( d.body ) )
+            d.body = fc::prune_invalid_utf8( d.body );
+      }
 
-         if ( start_author.size() && start_permlink.size() ) // for paging
+      template< typename Index >
+      typename Index::const_iterator dapp_api_impl::feed_begin( const Index& feed_idx, typename Index::const_iterator itr,
+                                                                const string& dapp_name, const string& start_author, const string& start_permlink )const
+      {
+         if( start_author.size() && start_permlink.size() ) // for paging
          {
+            auto& _db = *(_app.chain_database());
+            const auto& permlink_idx = _db.get_index< dapp_comment_index >().indices().get< by_permlink >();
             auto start_comment = permlink_idx.find( boost::make_tuple( dapp_name, start_author, start_permlink ) );
-            FC_ASSERT( start_comment != permlink_idx.end(), "Comment is not in account's comments" );
-            comment_itr = comment_idx.iterator_to( *start_comment );
+            FC_ASSERT( start_comment != permlink_idx.end(), "Comment is not in dapp's comments" );
+
+            const auto& comment_feed_idx = _db.get_index< dapp_feed_index >().indices().get< by_comment >();
+            auto feed_itr = comment_feed_idx.find( start_comment->id );
+            FC_ASSERT( feed_itr != comment_feed_idx.end(), "Comment is not a post" );
+            itr = feed_idx.iterator_to( *feed_itr );
          }
+         return itr;
+      }
 
-         result.reserve(query.limit);
+      template< typename Index >
+      vector< dapp_discussion_summary > dapp_api_impl::get_dapp_feed( const Index& feed_idx, typename Index::const_iterator itr, uint32_t limit,
+                                                                      const std::function< bool( const dapp_feed_object& ) >& in_feed )const
+      {
+         vector< dapp_discussion_summary > result;
+#ifndef IS_LOW_MEM
+         auto& _db = *(_app.chain_database());
+         result.reserve( limit );
 
-         while ( result.size() < query.limit && comment_itr != comment_idx.end() && dapp_name == comment_itr->dapp_name )
+         while( itr != feed_idx.end() && result.size() < limit && in_feed( *itr ) )
          {
-            dlog( "get_dapp_discussions : author = ${author}, permlink = ${permlink}"
-               , ( "author", comment_itr->author )( "permlink", comment_itr->permlink ) );
-            if( !ignore_parent && comment_itr->parent_author != parent_author ) break;
+            const auto& comment = _db.get( itr->comment );
+            result.emplace_back( comment );
+            result.back().title = _content.load( comment.title );
+            ++itr;
+         }
+#endif
+         return result;
+      }
 
-            try
-            {
-               dapp_discussion comment = get_dapp_discussion( comment_itr->id, query.truncate_body );
+      vector< dapp_discussion_summary > dapp_api_impl::get_dapp_feed_by_created( string dapp_name, string start_author, string start_permlink, uint32_t limit )const
+      {
+         try
+         {
+            FC_ASSERT( limit <= 100 );
+            const auto& feed_idx = _app.chain_database()->get_index< dapp_feed_index >().indices().get< by_dapp_created >();
+            auto itr = feed_begin( feed_idx, feed_idx.lower_bound( dapp_name_type( dapp_name ) ), dapp_name, start_author, start_permlink );
 
-               if( filter( comment ) ) 
-               {
-                  ++comment_itr;
-                  continue;
-               }
-               else if( exit( comment ) ) break;
+            return get_dapp_feed( feed_idx, itr, limit, [&]( const dapp_feed_object& f ){ return f.dapp_name == dapp_name; } );
+         }
+         FC_CAPTURE_AND_RETHROW( (dapp_name)(start_author)(start_permlink)(limit) )
+      }
 
-               result.emplace_back( comment );
-            }
-            catch (const fc::exception &e)
-            {
-               edump((e.to_detail_string()));
-            }
+      vector< dapp_discussion_summary > dapp_api_impl::get_dapp_feed_by_trending( string dapp_name, string start_author, string start_permlink, uint32_t limit )const
+      {
+         try
+         {
+            FC_ASSERT( limit <= 100 );
+            const auto& feed_idx = _app.chain_database()->get_index< dapp_feed_index >().indices().get< by_dapp_trending >();
+            auto itr = feed_begin( feed_idx, feed_idx.lower_bound( dapp_name_type( dapp_name ) ), dapp_name, start_author, start_permlink );
 
-            ++comment_itr;
+            return get_dapp_feed( feed_idx, itr, limit, [&]( const dapp_feed_object& f ){ return f.dapp_name == dapp_name; } );
          }
-#endif
+         FC_CAPTURE_AND_RETHROW( (dapp_name)(start_author)(start_permlink)(limit) )
+      }
 
-         dlog( "get_dapp_discussions : result.size() = ${size}", ( "size", result.size() ) );
-         return result;
+      vector< dapp_discussion_summary > dapp_api_impl::get_dapp_feed_by_author( string dapp_name, string author, string start_permlink, uint32_t limit )const
+      {
+         try
+         {
+            FC_ASSERT( limit <= 100 );
+            const auto& feed_idx = _app.chain_database()->get_index< dapp_feed_index >().indices().get< by_dapp_author_created >();
+            account_name_type author_name( author );
+            auto itr = feed_begin( feed_idx, feed_idx.lower_bound( boost::make_tuple( dapp_name_type( dapp_name ), author_name ) ), dapp_name, author, start_permlink );
+
+            return get_dapp_feed( feed_idx, itr, limit, [&]( const dapp_feed_object& f ){ return f.dapp_name == dapp_name && f.author == author_name; } );
+         }
+         FC_CAPTURE_AND_RETHROW( (dapp_name)(author)(start_permlink)(limit) )
       }
 
       vector< dapp_discussion > dapp_api_impl::lookup_dapp_contents( string dapp_name, string last_author, string last_permlink, uint32_t limit )const
       {
          try
          {
-            auto db = _app.chain_database();
             FC_ASSERT( limit > 0 && limit <= 100 );
             vector< dapp_discussion > results;
+#ifndef IS_LOW_MEM
             results.reserve( limit );
 
-            const auto& created_idx = db->get_index< dapp_comment_index >().indices().get< by_dapp_and_created >();
-            auto created_itr = created_idx.lower_bound( boost::make_tuple( dapp_name, time_point_sec::maximum() ) );
-
-            dapp_discussion_query q;
-            q.dapp_name = dapp_name;
-            q.limit = limit;
-            q.truncate_body = 1024;
-            if( last_author.size() > 0)
-               q.start_author = last_author;
-            if( last_permlink.size() > 0)
-               q.start_permlink = last_permlink;
-
             dlog("lookup_dapp_contents : dapp = ${dapp}, start_author = ${author}, start_permlink = ${permlink}"
                , ( "dapp", dapp_name )( "author", last_author )( "permlink", last_permlink ) );
 
-            vector< dapp_discussion > discussions = get_dapp_discussions( q, created_idx, created_itr
-               , []( const dapp_comment_api_obj& c ){ return c.parent_author.size() > 0; }
-               , exit_default
-               , true );
+            // the feed holds top level posts only, so replies never have to be skipped
+            const auto& feed_idx = _app.chain_database()->get_index< dapp_feed_index >().indices().get< by_dapp_created >();
+            auto itr = feed_begin( feed_idx, feed_idx.lower_bound( dapp_name_type( dapp_name ) ), dapp_name, last_author, last_permlink );
 
-            auto itr = discussions.begin();
-            while( itr != discussions.end() ){
-               results.emplace_back( *itr );
-               itr++;
+            while( itr != feed_idx.end() && itr->dapp_name == dapp_name && results.size() < limit )
+            {
+               results.emplace_back( get_dapp_discussion( itr->comment, 1024 ) );
+               ++itr;
             }
-
+#endif
             return results;
          }
          FC_CAPTURE_AND_RETHROW( ( dapp_name )( last_author )( last_permlink )( limit ) )
@@ -284,8 +306,9 @@ namespace sigmaengine { namespace dapp {
                if( itr->parent_author.size() == 0 )
                {
                   result.emplace_back( *itr );
-                  result.back().like_votes = get_dapp_active_votes( dapp_name, itr->author, to_string( itr->permlink ), comment_vote_type::LIKE );
-                  result.back().dislike_votes = get_dapp_active_votes( dapp_name, itr->author, to_string( itr->permlink ), comment_vote_type::DISLIKE );
+                  load_content( result.back(), *itr );
+                  result.back().like_votes = get_comment_votes( itr->id, comment_vote_type::LIKE );
+                  result.back().dislike_votes = get_comment_votes( itr->id, comment_vote_type::DISLIKE );
                   ++count;
                }
                ++itr;
@@ -326,8 +349,9 @@ namespace sigmaengine { namespace dapp {
             while( itr != last_update_idx.end() && result.size() < limit && itr->parent_author == *parent_author )
             {
                result.emplace_back( *itr );
-               result.back().like_votes = get_dapp_active_votes( dapp_name, itr->author, to_string( itr->permlink ), comment_vote_type::LIKE );
-               result.back().dislike_votes = get_dapp_active_votes( dapp_name, itr->author, to_string( itr->permlink ), comment_vote_type::DISLIKE );
+               load_content( result.back(), *itr );
+               result.back().like_votes = get_comment_votes( itr->id, comment_vote_type::LIKE );
+               result.back().dislike_votes = get_comment_votes( itr->id, comment_vote_type::DISLIKE );
                ++itr;
             }
 #endif
@@ -340,26 +364,30 @@ namespace sigmaengine { namespace dapp {
       {
          try
          {
-            vector< dapp_comment_vote_api_object > result;
             const auto& dapp_comment = _app.chain_database()->get< dapp_comment_object, by_permlink >( boost::make_tuple(dapp_name, author, permlink ) );
-            const auto& idx = _app.chain_database()->get_index< dapp_comment_vote_index >().indices().get< by_comment_voter >();
-            dapp_comment_id_type dcid(dapp_comment.id);
-            auto itr = idx.lower_bound( dcid );
-            while( itr != idx.end() && itr->comment == dcid )
-            {
-               if( itr->vote_type == type ) {
-                  const auto& vo = _app.chain_database()->get(itr->voter);
-                  dapp_comment_vote_api_object vstate;
-                  vstate.voter = vo.name;
-                  vstate.time = itr->last_update;
+            return get_comment_votes( dapp_comment.id, type );
+         }
+         FC_CAPTURE_AND_RETHROW( (dapp_name)(author)(permlink) )
+      }
 
-                  result.emplace_back(vstate);
-               }
-               ++itr;
+      vector< dapp_comment_vote_api_object > dapp_api_impl::get_comment_votes( dapp_comment_id_type comment, comment_vote_type type )const
+      {
+         vector< dapp_comment_vote_api_object > result;
+         const auto& idx = _app.chain_database()->get_index< dapp_comment_vote_index >().indices().get< by_comment_voter >();
+         auto itr = idx.lower_bound( comment );
+         while( itr != idx.end() && itr->comment == comment )
+         {
+            if( itr->vote_type == type ) {
+               const auto& vo = _app.chain_database()->get(itr->voter);
+               dapp_comment_vote_api_object vstate;
+               vstate.voter = vo.name;
+               vstate.time = itr->last_update;
+
+               result.emplace_back(vstate);
             }
-            return result;
+            ++itr;
          }
-         FC_CAPTURE_AND_RETHROW( (dapp_name)(author)(permlink) )
+         return result;
       }
 
       vector< dapp_account_vote_api_object > dapp_api_impl::get_dapp_account_votes( string dapp_name, string voter )const
@@ -588,6 +616,20 @@ namespace sigmaengine { namespace dapp {
          FC_CAPTURE_AND_RETHROW( (dapp_name)(author)(unique_id)(owner) )
       }
 
+      /**
+       * Returns the iterator to the from-th element of the equal range of key in a ranked index,
+       * or the end of that range.  O(log n) regardless of from.
+       */
+      template< typename Index, typename Key >
+      typename Index::const_iterator dapp_api_impl::nth_in_range( const Index& idx, const Key& key, uint32_t from )
+      {
+         auto first = idx.rank( idx.lower_bound( key ) );
+         auto last = idx.upper_bound( key );
+         if( first + from >= idx.rank( last ) )
+            return last;
+         return idx.nth( first + from );
+      }
+
       vector <dapp_nsta602_owner_api_object> dapp_api_impl::get_nsta602_by_owner( string owner, uint32_t from, uint32_t limit, bool newest ) const
       {
          try
@@ -604,13 +646,7 @@ namespace sigmaengine { namespace dapp {
             {
                const auto& idx = _app.chain_database()->get_index< dapp_nsta602_owner_index >().indices().get< by_owner_newest >();
                //auto itr = idx.lower_bound( boost::make_tuple( owner, owner_from_id ) );
-               auto itr = idx.lower_bound( owner );
-
-               while( itr != idx.end() && itr->owner == owner && from > 0)
-               {
-                  ++itr;
-                  --from;
-               }
+               auto itr = nth_in_range( idx, owner, from );
 
                vector<dapp_nsta602_owner_api_object> result;
                uint32_t num = 0;
@@ -627,12 +663,7 @@ namespace sigmaengine { namespace dapp {
             {
                const auto& idx = _app.chain_database()->get_index< dapp_nsta602_owner_index >().indices().get< by_owner >();
                //auto itr = idx.lower_bound( boost::make_tuple( owner, owner_from_id ) );
-               auto itr = idx.lower_bound( owner );
-               while( itr != idx.end() && itr->owner == owner && from > 0)
-               {
-                  ++itr;
-                  --from;
-               }
+               auto itr = nth_in_range( idx, owner, from );
 
                vector<dapp_nsta602_owner_api_object> result;
                uint32_t num = 0;
@@ -665,13 +696,7 @@ namespace sigmaengine { namespace dapp {
             {
                const auto& idx = _app.chain_database()->get_index< dapp_nsta602_index >().indices().get< by_author_newest >();
                //auto itr = idx.lower_bound( boost::make_tuple( author, from_id ) );
-               auto itr = idx.lower_bound( author );
-
-               while( itr != idx.end() && itr->author == author && from > 0)
-               {
-                  ++itr;
-                  --from;
-               }
+               auto itr = nth_in_range( idx, author, from );
 
                vector<dapp_nsta602_api_object> result;
                uint32_t num = 0;
@@ -688,13 +713,7 @@ namespace sigmaengine { namespace dapp {
             {
                const auto& idx = _app.chain_database()->get_index< dapp_nsta602_index >().indices().get< by_author >();
                //auto itr = idx.lower_bound( boost::make_tuple( author, from_id ) );
-               auto itr = idx.lower_bound( author );
-
-               while( itr != idx.end() && itr->author == author && from > 0)
-               {
-                  ++itr;
-                  --from;
-               }
+               auto itr = nth_in_range( idx, author, from );
 
                vector<dapp_nsta602_api_object> result;
                uint32_t num = 0;
@@ -785,6 +804,30 @@ namespace sigmaengine { namespace dapp {
       });
    }
 
+   vector< dapp_discussion_summary > dapp_api::get_dapp_feed_by_created( string dapp_name, string start_author, string start_permlink, uint32_t limit )const
+   {
+      return _my->database().with_read_lock( [ & ]()
+      {
+         return _my->get_dapp_feed_by_created( dapp_name, start_author, start_permlink, limit );
+      });
+   }
+
+   vector< dapp_discussion_summary > dapp_api::get_dapp_feed_by_trending( string dapp_name, string start_author, string start_permlink, uint32_t limit )const
+   {
+      return _my->database().with_read_lock( [ & ]()
+      {
+         return _my->get_dapp_feed_by_trending( dapp_name, start_author, start_permlink, limit );
+      });
+   }
+
+   vector< dapp_discussion_summary > dapp_api::get_dapp_feed_by_author( string dapp_name, string author, string start_permlink, uint32_t limit )const
+   {
+      return _my->database().with_read_lock( [ & ]()
+      {
+         return _my->get_dapp_feed_by_author( dapp_name, author, start_permlink, limit );
+      });
+   }
+
    vector< dapp_comment_vote_api_object > dapp_api::get_dapp_active_votes( string dapp_name, string author, string permlink, comment_vote_type type ) const
    {
       return _my->database().with_read_lock( [ & ]()
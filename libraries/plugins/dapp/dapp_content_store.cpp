@@ -0,0 +1,198 @@
+#include <sigmaengine/dapp/dapp_content_store.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+#define CONTENT_READ  (std::ios::in | std::ios::binary)
+#define CONTENT_WRITE (std::ios::out | std::ios::binary | std::ios::app)
+
+namespace sigmaengine { namespace dapp {
+
+   namespace detail {
+      /// each record is [sha256 of content][uint32 size][content]
+      static const uint64_t record_header_size = sizeof( fc::sha256 ) + sizeof( uint32_t );
+
+      class dapp_content_store_impl
+      {
+         public:
+            fc::path                                              file;
+            std::fstream                                          read_stream;
+            std::fstream                                          write_stream;
+            uint64_t                                              end = 0;
+            bool                                                  read_only = false;
+            std::unordered_map< fc::sha256, dapp_content_ref >    by_hash;
+            mutable std::mutex                                    mutex;
+
+            /**
+             * On a read only node, takes the end from the size of the file.  The writer flushes a record
+             * before the reference to it reaches the shared memory file, so every referenced record is
+             * complete even if the file ends with one that is not.
+             */
+            void refresh()
+            {
+               if( !fc::exists( file ) )
+                  return;
+               if( !read_stream.is_open() )
+                  read_stream.open( file.generic_string().c_str(), CONTENT_READ );
+               end = fc::file_size( file );
+            }
+
+            /// rebuilds the hash index and cuts off a record torn by a crash
+            void scan()
+            {
+               uint64_t file_size = fc::file_size( file );
+               uint64_t pos = 0;
+
+               read_stream.open( file.generic_string().c_str(), CONTENT_READ );
+               while( pos + record_header_size <= file_size )
+               {
+                  fc::sha256 hash;
+                  uint32_t size = 0;
+                  read_stream.seekg( pos );
+                  read_stream.read( hash.data(), sizeof( hash ) );
+                  read_stream.read( (char*)&size, sizeof( size ) );
+                  if( !read_stream || pos + record_header_size + size > file_size )
+                     break;
+
+                  dapp_content_ref ref;
+                  ref.offset = pos + record_header_size;
+                  ref.size = size;
+                  by_hash[ hash ] = ref;
+                  pos = ref.offset + size;
+               }
+               read_stream.close();
+
+               if( pos != file_size )
+               {
+                  wlog( "Truncating incomplete record at the end of ${f} (${p} of ${s} bytes are valid)",
+                        ("f", file)("p", pos)("s", file_size) );
+                  fc::resize_file( file, pos );
+               }
+               end = pos;
+            }
+      };
+   }
+
+   dapp_content_store::dapp_content_store() : my( new detail::dapp_content_store_impl() ) {}
+
+   dapp_content_store::~dapp_content_store()
+   {
+      close();
+   }
+
+   void dapp_content_store::open( const fc::path& file, bool read_only )
+   {
+      try
+      {
+         std::lock_guard< std::mutex > lock( my->mutex );
+         if( my->read_stream.is_open() )
+            my->read_stream.close();
+         if( my->write_stream.is_open() )
+            my->write_stream.close();
+         my->by_hash.clear();
+
+         my->file = file;
+         my->read_only = read_only;
+         my->end = 0;
+         if( read_only )
+         {
+            // the writer's file is never scanned for a torn record, cutting one off could cut off the record it is appending
+            my->refresh();
+            ilog( "Opened dapp content store ${f} read only", ("f", file) );
+            return;
+         }
+
+         if( !fc::exists( file.parent_path() ) )
+            fc::create_directories( file.parent_path() );
+         if( !fc::exists( file ) )
+            std::ofstream( file.generic_string().c_str(), CONTENT_WRITE );
+
+         my->scan();
+
+         my->write_stream.open( file.generic_string().c_str(), CONTENT_WRITE );
+         my->read_stream.open( file.generic_string().c_str(), CONTENT_READ );
+         FC_ASSERT( my->write_stream && my->read_stream, "Unable to open dapp content file ${f}", ("f", file) );
+
+         ilog( "Opened dapp content store ${f} with ${n} records", ("f", file)("n", my->by_hash.size()) );
+      }
+      FC_CAPTURE_AND_RETHROW( (file) )
+   }
+
+   void dapp_content_store::close()
+   {
+      std::lock_guard< std::mutex > lock( my->mutex );
+      if( my->write_stream.is_open() )
+      {
+         my->write_stream.flush();
+         my->write_stream.close();
+      }
+      if( my->read_stream.is_open() )
+         my->read_stream.close();
+      my->read_only = false;
+   }
+
+   bool dapp_content_store::is_open()const
+   {
+      return my->read_only || my->write_stream.is_open();
+   }
+
+   dapp_content_ref dapp_content_store::store( const std::string& content )
+   {
+      if( content.empty() )
+         return dapp_content_ref();
+
+      FC_ASSERT( content.size() <= std::numeric_limits< uint32_t >::max() );
+      auto hash = fc::sha256::hash( content );
+
+      std::lock_guard< std::mutex > lock( my->mutex );
+      auto itr = my->by_hash.find( hash );
+      if( itr != my->by_hash.end() )
+         return itr->second;
+
+      FC_ASSERT( !my->read_only, "dapp content store is read only" );
+      FC_ASSERT( my->write_stream.is_open(), "dapp content store is not open" );
+
+      dapp_content_ref ref;
+      ref.offset = my->end + detail::record_header_size;
+      ref.size = content.size();
+
+      my->write_stream.write( hash.data(), sizeof( hash ) );
+      my->write_stream.write( (const char*)&ref.size, sizeof( ref.size ) );
+      my->write_stream.write( content.data(), content.size() );
+      // readers use a separate stream, so the record has to reach the file before the reference is published
+      my->write_stream.flush();
+      FC_ASSERT( my->write_stream, "Unable to append to dapp content file ${f}", ("f", my->file) );
+
+      my->end = ref.offset + ref.size;
+      my->by_hash[ hash ] = ref;
+      return ref;
+   }
+
+   std::string dapp_content_store::load( const dapp_content_ref& ref, uint32_t max_size )const
+   {
+      if( ref.size == 0 )
+         return std::string();
+
+      uint32_t size = max_size ? std::min( ref.size, max_size ) : ref.size;
+      std::string result( size, '\0' );
+
+      std::lock_guard< std::mutex > lock( my->mutex );
+      if( my->read_only && ref.offset + ref.size > my->end )
+         my->refresh();
+      FC_ASSERT( ref.offset + ref.size <= my->end, "Reference past the end of the dapp content store",
+                 ("offset", ref.offset)("size", ref.size)("end", my->end) );
+
+      my->read_stream.clear();
+      my->read_stream.seekg( ref.offset );
+      my->read_stream.read( &result[0], size );
+      FC_ASSERT( my->read_stream, "Unable to read dapp content", ("offset", ref.offset)("size", size) );
+      return result;
+   }
+
+} } // sigmaengine::dapp
@@ -213,42 +213,36 @@ namespace sigmaengine { namespace dapp {
                }
 
 #ifndef IS_LOW_MEM
-               from_string( com.title, op.title );
+               auto& content = _plugin->content_store();
+               com.title = content.store( op.title );
                if ( op.body.size() < 1024 * 1024 * 128 )
                {
-                  from_string( com.body, op.body );
+                  com.body = content.store( op.body );
                }
                if ( fc::is_utf8( op.json_metadata ) )
-                  from_string( com.json_metadata, op.json_metadata );
+                  com.json_metadata = content.store( op.json_metadata );
                else
                   wlog( "Comment ${a}/${p} contains invalid UTF-8 metadata", ( "a", op.author )( "p", op.permlink ) );
 #endif
             });
 
             id = new_comment.id;
+            _plugin->queue_feed_update( new_comment.root_comment );
 
-            /// this loop can be skiped for validate-only nodes as it is merely gathering stats for indicies
-            auto now = _db.head_block_time();
-            while ( parent ) {
+            if ( parent ) {
+               auto now = _db.head_block_time();
                _db.modify( *parent, [&]( dapp_comment_object& p ) {
                   p.children++;
                   p.active = now;
                });
-#ifndef IS_LOW_MEM
-               if ( parent->parent_author != SIGMAENGINE_ROOT_POST_PARENT )
-               {
-                  parent = &_db.get< dapp_comment_object, by_permlink >( 
-                     boost::make_tuple( parent->dapp_name, parent->parent_author, parent->parent_permlink ) );
-               }
-               else
-#endif
-                  parent = nullptr;
+               _plugin->queue_ancestor_update( *parent, 1, now );
             }
          } // END create comment
          else // START edit comment
          {
             dlog( "comment_dapp_evaluator : update");
             const auto& comment = *itr;
+            _plugin->queue_feed_update( comment.root_comment );
 
             _db.modify( comment, [&](dapp_comment_object& com )
             {
@@ -268,11 +262,12 @@ namespace sigmaengine { namespace dapp {
                }
 
 #ifndef IS_LOW_MEM
-               if ( op.title.size() ) from_string( com.title, op.title );
+               auto& content = _plugin->content_store();
+               if ( op.title.size() ) com.title = content.store( op.title );
                if ( op.json_metadata.size() )
                {
                   if ( fc::is_utf8( op.json_metadata ) )
-                     from_string( com.json_metadata, op.json_metadata );
+                     com.json_metadata = content.store( op.json_metadata );
                   else
                      wlog("Comment ${a}/${p} contains invalid UTF-8 metadata", ("a", op.author)("p", op.permlink));
                }
@@ -282,20 +277,20 @@ namespace sigmaengine { namespace dapp {
                      diff_match_patch<std::wstring> dmp;
                      auto patch = dmp.patch_fromText( utf8_to_wstring( op.body ) );
                      if ( patch.size() ) {
-                        auto result = dmp.patch_apply( patch, utf8_to_wstring( to_string( com.body ) ) );
+                        auto result = dmp.patch_apply( patch, utf8_to_wstring( content.load( com.body ) ) );
                         auto patched_body = wstring_to_utf8( result.first );
                         if ( !fc::is_utf8(patched_body ) ) {
                            idump( ( "invalid utf8" )( patched_body ) );
-                           from_string( com.body, fc::prune_invalid_utf8( patched_body ) );
+                           com.body = content.store( fc::prune_invalid_utf8( patched_body ) );
                         }
-                        else { from_string(com.body, patched_body); }
+                        else { com.body = content.store( patched_body ); }
                      }
                      else { // replace
-                        from_string( com.body, op.body );
+                        com.body = content.store( op.body );
                      }
                   }
                   catch (...) {
-                     from_string( com.body, op.body );
+                     com.body = content.store( op.body );
                   }
                }
 #endif
@@ -350,6 +345,8 @@ namespace sigmaengine { namespace dapp {
                
          });
 
+         _plugin->queue_feed_update( dapp_comment.root_comment );
+
          _db.modify( dapp_comment, [&]( dapp_comment_object &c ) 
          {
             if (vote_type == comment_vote_type::LIKE)
@@ -398,7 +395,7 @@ namespace sigmaengine { namespace dapp {
             , ( "dapp_name", op.dapp_name )( "author", op.author )( "permlink", op.permlink ) );
 
          const auto& comment = *comment_ptr;
-         FC_ASSERT( comment.children == 0, "Cannot delete a comment with replies." );
+         FC_ASSERT( int64_t( comment.children ) + _plugin->pending_children( comment ) == 0, "Cannot delete a comment with replies." );
 
          // process dapp transaction fee
          const auto& dapp_name_idx = _db.get_index< dapp_index >().indices().get< by_name >();
@@ -411,38 +408,45 @@ namespace sigmaengine { namespace dapp {
          FC_ASSERT( from_account.balance >= dapp_transaction_fee, "Balance of ${account} account is less than dapp transaction fee"
                , ( "account", op.author ) );
 
-         // remove vote of this comment.
+         // remove the votes of this comment with the comment, so none is left pointing at it
          const auto& vote_idx = _db.get_index< dapp_comment_vote_index >().indices().get< by_comment_voter >();
          auto vote_itr = vote_idx.lower_bound( dapp_comment_id_type( comment.id ) );
-
-         while( vote_itr != vote_idx.end() && vote_itr->comment == comment.id ) 
+         while( vote_itr != vote_idx.end() && vote_itr->comment == comment.id )
          {
             const auto& cur_vote = *vote_itr;
             ++vote_itr;
             _db.remove( cur_vote );
          }
 
-         // decrease child count of all parent comment
+         // decrease child count of the parent now, the ancestors above it are updated at the end of the block
          if( comment.parent_author != SIGMAENGINE_ROOT_POST_PARENT )
          {
-            auto parent = comment_index.find( boost::make_tuple( comment.dapp_name, comment.parent_author, comment.parent_permlink ) );
+            const auto& parent = _db.get< dapp_comment_object, by_permlink >(
+               boost::make_tuple( comment.dapp_name, comment.parent_author, comment.parent_permlink ) );
+            // changes still queued for this comment belong to its ancestors once it is gone
+            int32_t children = _plugin->take_pending_children( comment ) - 1;
             auto now = _db.head_block_time();
-            while( parent != comment_index.end() )
+
+            _db.modify( parent, [&]( dapp_comment_object& p )
             {
-               _db.modify( *parent, [&]( dapp_comment_object& p )
-               {
-                  p.children--;
-                  p.active = now;
-               });
-               
+               p.children += children;
+               p.active = now;
+            });
+            _plugin->queue_ancestor_update( parent, children, now );
+         }
+
+         _plugin->queue_feed_update( comment.root_comment );
+
 #ifndef IS_LOW_MEM
-               if( parent->parent_author != SIGMAENGINE_ROOT_POST_PARENT )
-                  parent = comment_index.find( boost::make_tuple( parent->dapp_name, parent->parent_author, parent->parent_permlink ) );
-               else
-#endif
-                  break;
-            }
+         // the feed entry of a root post goes with it, so feed queries never see it without its comment
+         if( comment.parent_author == SIGMAENGINE_ROOT_POST_PARENT )
+         {
+            const auto& feed_idx = _db.get_index< dapp_feed_index >().indices().get< by_comment >();
+            auto feed_itr = feed_idx.find( comment.id );
+            if( feed_itr != feed_idx.end() )
+               _db.remove( *feed_itr );
          }
+#endif
 
          // remove this comment
          _db.remove( comment );
@@ -6,6 +6,8 @@
 #include <sigmaengine/chain/generic_custom_operation_interpreter.hpp>
 #include <sigmaengine/chain/index.hpp>
 
+#include <functional>
+#include <map>
 #include <memory>
 
 namespace sigmaengine { namespace dapp {
@@ -22,14 +24,32 @@ namespace sigmaengine { namespace dapp {
                return _self.database();
             }
 
+            dapp_content_store& content_store() { return _content_store; }
+
             void on_apply_hardfork( const uint32_t hardfork );
+            void on_pre_apply_block( const signed_block& b );
             void on_apply_block( const signed_block& b );
 
+            struct pending_comment_update
+            {
+               int32_t           children = 0;
+               time_point_sec    active;
+            };
+
+            /// (depth, comment), ordered deepest first
+            typedef std::pair< uint16_t, dapp_comment_id_type > comment_depth_key;
+
+            std::map< comment_depth_key, pending_comment_update, std::greater< comment_depth_key > > _pending_ancestors;
+            flat_set< dapp_comment_id_type > _pending_feed_updates;
+
          private:
+            void apply_pending_comment_updates( sigmaengine::chain::database& _db );
+            void apply_pending_feed_updates( sigmaengine::chain::database& _db );
             void aggregate_dapp_approve_vote( sigmaengine::chain::database& _db );
             void aggregate_trx_fee_vote( sigmaengine::chain::database& _db );
 
             dapp_plugin&  _self;
+            dapp_content_store _content_store;
             std::shared_ptr< generic_custom_operation_interpreter< sigmaengine::dapp::dapp_operation > > _custom_op_interpreter;
       };
 
@@ -187,8 +207,74 @@ namespace sigmaengine { namespace dapp {
          }
       }
 
+      void dapp_plugin_impl::apply_pending_comment_updates( sigmaengine::chain::database& _db ) {
+         // deepest comments first, so every ancestor has collected the changes of its whole subtree before it is modified
+         while( !_pending_ancestors.empty() ) {
+            auto itr = _pending_ancestors.begin();
+            const auto& comment = _db.get( itr->first.second );
+            auto update = itr->second;
+            _pending_ancestors.erase( itr );
+
+            _db.modify( comment, [&]( dapp_comment_object& c ) {
+               c.children += update.children;
+               c.active = update.active;
+            });
+
+            if( comment.parent_author != SIGMAENGINE_ROOT_POST_PARENT ) {
+               const auto& parent = _db.get< dapp_comment_object, by_permlink >(
+                  boost::make_tuple( comment.dapp_name, comment.parent_author, comment.parent_permlink ) );
+               auto& next = _pending_ancestors[ std::make_pair( parent.depth, parent.id ) ];
+               next.children += update.children;
+               next.active = std::max( next.active, update.active );
+            }
+         }
+      }
+
+      void dapp_plugin_impl::apply_pending_feed_updates( sigmaengine::chain::database& _db ) {
+         const auto& feed_idx = _db.get_index< dapp_feed_index >().indices().get< by_comment >();
+
+         for( const auto& id : _pending_feed_updates ) {
+            const auto* comment = _db.find< dapp_comment_object >( id );
+            auto feed_itr = feed_idx.find( id );
+
+            if( comment == nullptr || comment->parent_author != SIGMAENGINE_ROOT_POST_PARENT ) {
+               if( feed_itr != feed_idx.end() )
+                  _db.remove( *feed_itr );
+               continue;
+            }
+
+            auto update = [&]( dapp_feed_object& f ) {
+               f.active = comment->active;
+               f.trending = int64_t( comment->like_count ) - comment->dislike_count + comment->children;
+            };
+
+            if( feed_itr == feed_idx.end() ) {
+               _db.create< dapp_feed_object >( [&]( dapp_feed_object& f ) {
+                  f.dapp_name = comment->dapp_name;
+                  f.comment = comment->id;
+                  f.author = comment->author;
+                  f.created = comment->created;
+                  update( f );
+               });
+            } else {
+               _db.modify( *feed_itr, update );
+            }
+         }
+         _pending_feed_updates.clear();
+      }
+
+      void dapp_plugin_impl::on_pre_apply_block( const signed_block& b ) {
+         // anything queued by pending transactions or a block that failed to apply is stale
+         _pending_ancestors.clear();
+         _pending_feed_updates.clear();
+      }
+
       void dapp_plugin_impl::on_apply_block( const signed_block& b ) {
          auto& _db = database();
+         apply_pending_comment_updates( _db );
+         // after the ancestors, so root posts carry their final child count
+         apply_pending_feed_updates( _db );
+
          auto now = _db.head_block_time();
          const dynamic_global_property_object& _dgp = _db.get_dynamic_global_properties();
 
@@ -210,6 +296,17 @@ namespace sigmaengine { namespace dapp {
    dapp_plugin::dapp_plugin( application* app ) 
    : plugin( app ), _my( new detail::dapp_plugin_impl( *this ) ) {}
 
+   void dapp_plugin::plugin_set_program_options(
+      boost::program_options::options_description& cli,
+      boost::program_options::options_description& cfg )
+   {
+      cli.add_options()
+            ("dapp-content-file", boost::program_options::value< string >(),
+               "File holding dapp comment titles, bodies and metadata. Defaults to dapp_content.bin next to the shared memory file")
+            ;
+      cfg.add( cli );
+   }
+
    void dapp_plugin::plugin_initialize( const boost::program_options::variables_map& options )
    {
       try 
@@ -218,6 +315,26 @@ namespace sigmaengine { namespace dapp {
 
          _my->plugin_initialize();
 
+#ifndef IS_LOW_MEM
+         fc::path content_file;
+         if( options.count( "dapp-content-file" ) )
+            content_file = fc::path( options.at( "dapp-content-file" ).as< string >() );
+         else
+         {
+            fc::path shared_dir;
+            if( options.count( "shared-file-dir" ) )
+               shared_dir = fc::path( options.at( "shared-file-dir" ).as< string >() );
+            else if( options.count( "data-dir" ) )
+               shared_dir = fc::path( options.at( "data-dir" ).as< boost::filesystem::path >() ) / "blockchain";
+            else
+               shared_dir = fc::path( "blockchain" );
+            content_file = shared_dir / "dapp_content.bin";
+         }
+         if( content_file.is_relative() )
+            content_file = fc::current_path() / content_file;
+         _my->content_store().open( content_file, options.count( "read-only" ) > 0 );
+#endif
+
          chain::database& db = database();
          add_plugin_index < dapp_index > ( db );
          add_plugin_index < dapp_comment_index > ( db );
@@ -227,11 +344,16 @@ namespace sigmaengine { namespace dapp {
          add_plugin_index < dapp_trx_fee_vote_index > ( db );
          add_plugin_index < dapp_nsta602_index > ( db );
          add_plugin_index < dapp_nsta602_owner_index > ( db );
+         add_plugin_index < dapp_feed_index > ( db );
 
          db.on_apply_hardfork.connect( [&]( const uint32_t hardfork ){ 
             _my->on_apply_hardfork( hardfork ); 
          });
 
+         db.pre_apply_block.connect( [&]( const signed_block& b ){
+            _my->on_pre_apply_block( b );
+         });
+
          db.applied_block.connect( [&]( const signed_block& b ){ 
             _my->on_apply_block( b ); 
          });
@@ -244,6 +366,54 @@ namespace sigmaengine { namespace dapp {
       app().register_api_factory< dapp_api >( "dapp_api" );
    }
 
+   void dapp_plugin::plugin_shutdown()
+   {
+      _my->content_store().close();
+   }
+
+   dapp_content_store& dapp_plugin::content_store()
+   {
+      return _my->content_store();
+   }
+
+   void dapp_plugin::queue_ancestor_update( const dapp_comment_object& parent, int32_t children, time_point_sec active )
+   {
+#ifndef IS_LOW_MEM
+      if( parent.parent_author == SIGMAENGINE_ROOT_POST_PARENT )
+         return;
+
+      const auto& grand_parent = database().get< dapp_comment_object, by_permlink >(
+         boost::make_tuple( parent.dapp_name, parent.parent_author, parent.parent_permlink ) );
+      auto& update = _my->_pending_ancestors[ std::make_pair( grand_parent.depth, grand_parent.id ) ];
+      update.children += children;
+      update.active = std::max( update.active, active );
+#endif
+   }
+
+   int32_t dapp_plugin::pending_children( const dapp_comment_object& c )const
+   {
+      auto itr = _my->_pending_ancestors.find( std::make_pair( c.depth, c.id ) );
+      return itr != _my->_pending_ancestors.end() ? itr->second.children : 0;
+   }
+
+   int32_t dapp_plugin::take_pending_children( const dapp_comment_object& c )
+   {
+      auto itr = _my->_pending_ancestors.find( std::make_pair( c.depth, c.id ) );
+      if( itr == _my->_pending_ancestors.end() )
+         return 0;
+
+      int32_t children = itr->second.children;
+      _my->_pending_ancestors.erase( itr );
+      return children;
+   }
+
+   void dapp_plugin::queue_feed_update( dapp_comment_id_type root_comment )
+   {
+#ifndef IS_LOW_MEM
+      _my->_pending_feed_updates.insert( root_comment );
+#endif
+   }
+
 } } //namespace sigmaengine::dapp
 
 SIGMAENGINE_DEFINE_PLUGIN( dapp, sigmaengine::dapp::dapp_plugin )
@@ -50,6 +50,10 @@ namespace sigmaengine { namespace dapp {
       string               dapp_name;
    };
 
+   /**
+    * title, body and json_metadata are left empty by the constructor; they are kept in the
+    * dapp_content_store and dapp_api loads them only for the entries it actually returns.
+    */
    struct dapp_comment_api_obj
    {
       dapp_comment_api_obj( const dapp_comment_object& o ):
@@ -60,9 +64,6 @@ namespace sigmaengine { namespace dapp {
          parent_permlink( to_string( o.parent_permlink ) ),
          author( o.author ),
          permlink( to_string( o.permlink ) ),
-         title( to_string( o.title ) ),
-         body( to_string( o.body ) ),
-         json_metadata( to_string( o.json_metadata ) ),
          last_update( o.last_update ),
          created( o.created ),
          active( o.active ),
@@ -150,14 +151,6 @@ namespace sigmaengine { namespace dapp {
    };
 
    struct simple_dapp_discussion {
-      simple_dapp_discussion( const dapp_comment_object& object ):
-         id( object.id ),
-         dapp_name( object.dapp_name ),
-         author( object.author ), 
-         permlink( to_string( object.permlink ) ), 
-         title( to_string( object.title ) ), 
-         created( object.created )
-         {}
       simple_dapp_discussion( const dapp_discussion& object ):
          id( object.id ),
          dapp_name( object.dapp_name ),
@@ -176,6 +169,43 @@ namespace sigmaengine { namespace dapp {
       time_point_sec          created;
    };
 
+   /**
+    * What a feed page needs to list a post: no body, no votes.
+    * The title is the only content read from the dapp_content_store.
+    */
+   struct dapp_discussion_summary
+   {
+      dapp_discussion_summary( const dapp_comment_object& o ):
+         id( o.id ),
+         dapp_name( o.dapp_name ),
+         category( to_string( o.category ) ),
+         author( o.author ),
+         permlink( to_string( o.permlink ) ),
+         created( o.created ),
+         last_update( o.last_update ),
+         active( o.active ),
+         children( o.children ),
+         like_count( o.like_count ),
+         dislike_count( o.dislike_count ),
+         body_length( o.body.size )
+      {}
+      dapp_discussion_summary(){}
+
+      dapp_comment_id_type    id;
+      dapp_name_type          dapp_name;
+      string                  category;
+      account_name_type       author;
+      string                  permlink;
+      string                  title;
+      time_point_sec          created;
+      time_point_sec          last_update;
+      time_point_sec          active;
+      uint32_t                children = 0;
+      uint32_t                like_count = 0;
+      uint32_t                dislike_count = 0;
+      uint32_t                body_length = 0;
+   };
+
    struct dapp_user_api_object
    {
       dapp_user_api_object() {}
@@ -350,6 +380,37 @@ namespace sigmaengine { namespace dapp {
           * */
          vector< dapp_discussion > lookup_dapp_contents( string dapp_name, string last_author, string last_permlink, uint32_t limit )const;
 
+         /**
+          * get the newest posts of a dapp, without bodies.
+          * @param dapp_name dapp name.
+          * @param start_author author of the post to start from (for paging), empty for the first page.
+          * @param start_permlink permlink of the post to start from (for paging), empty for the first page.
+          * @param limit max count of posts, 100 or less.
+          * @return post summaries, newest first.
+          * */
+         vector< dapp_discussion_summary > get_dapp_feed_by_created( string dapp_name, string start_author, string start_permlink, uint32_t limit )const;
+
+         /**
+          * get the posts of a dapp with the most likes and replies, without bodies.
+          * Posts are ranked by like count minus dislike count plus reply count, then by last activity.
+          * @param dapp_name dapp name.
+          * @param start_author author of the post to start from (for paging), empty for the first page.
+          * @param start_permlink permlink of the post to start from (for paging), empty for the first page.
+          * @param limit max count of posts, 100 or less.
+          * @return post summaries, highest ranked first.
+          * */
+         vector< dapp_discussion_summary > get_dapp_feed_by_trending( string dapp_name, string start_author, string start_permlink, uint32_t limit )const;
+
+         /**
+          * get the newest posts of an author in a dapp, without bodies.
+          * @param dapp_name dapp name.
+          * @param author author of the posts.
+          * @param start_permlink permlink of the post to start from (for paging), empty for the first page.
+          * @param limit max count of posts, 100 or less.
+          * @return post summaries, newest first.
+          * */
+         vector< dapp_discussion_summary > get_dapp_feed_by_author( string dapp_name, string author, string start_permlink, uint32_t limit )const;
+
          /**
           * get list of user of a dapp.
           * @param dapp_name dapp name.
@@ -453,6 +514,22 @@ FC_REFLECT( sigmaengine::dapp::simple_dapp_discussion,
    ( created )
 )
 
+FC_REFLECT( sigmaengine::dapp::dapp_discussion_summary,
+   ( id )
+   ( dapp_name )
+   ( category )
+   ( author )
+   ( permlink )
+   ( title )
+   ( created )
+   ( last_update )
+   ( active )
+   ( children )
+   ( like_count )
+   ( dislike_count )
+   ( body_length )
+)
+
 FC_REFLECT( sigmaengine::dapp::dapp_user_api_object, 
    ( dapp_id )
    ( dapp_name )
@@ -500,6 +577,9 @@ FC_API( sigmaengine::dapp::dapp_api,
    ( get_dapp_active_votes )
    ( get_dapp_account_votes )
    ( lookup_dapp_contents )
+   ( get_dapp_feed_by_created )
+   ( get_dapp_feed_by_trending )
+   ( get_dapp_feed_by_author )
    ( lookup_dapp_users )
    ( get_join_dapps )
    ( get_dapp_votes )
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <memory>
+#include <string>
+
+namespace sigmaengine { namespace dapp {
+
+   /**
+    * Location of a piece of dapp comment content inside the dapp_content_store.
+    * A zero size refers to the empty string and never touches the store.
+    */
+   struct dapp_content_ref
+   {
+      uint64_t offset = 0;
+      uint32_t size = 0;
+   };
+
+   namespace detail { class dapp_content_store_impl; }
+
+   /**
+    * Append-only, content-addressed file holding the large text fields of
+    * dapp comments (title, body and json metadata) outside of the shared
+    * memory file.  Objects keep only a dapp_content_ref, so modifying a
+    * comment no longer copies its body into the undo state.
+    *
+    * Records are never overwritten, which makes every reference handed out
+    * stay valid across undo and fork switches.  Identical content is stored
+    * once, so replaying the chain does not grow the file.
+    *
+    * Content is not consensus state: low memory nodes never store it.
+    *
+    * A read only node opens the file of the node that writes it.  It never
+    * changes the file, and picks up records appended after it opened the
+    * file when a reference points past the end it knows of.
+    */
+   class dapp_content_store
+   {
+      public:
+         dapp_content_store();
+         ~dapp_content_store();
+
+         void open( const fc::path& file, bool read_only = false );
+         void close();
+         bool is_open()const;
+
+         dapp_content_ref store( const std::string& content );
+
+         /** Loads the referenced content, or its first max_size bytes when max_size is not 0 */
+         std::string load( const dapp_content_ref& ref, uint32_t max_size = 0 )const;
+
+      private:
+         std::unique_ptr< detail::dapp_content_store_impl > my;
+   };
+
+} } // sigmaengine::dapp
+
+FC_REFLECT( sigmaengine::dapp::dapp_content_ref, (offset)(size) )
@@ -2,8 +2,10 @@
 
 #include <sigmaengine/app/plugin.hpp>
 #include <sigmaengine/chain/sigmaengine_object_types.hpp>
+#include <sigmaengine/dapp/dapp_content_store.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/ranked_index.hpp>
 
 namespace sigmaengine { namespace dapp {
    using namespace std;
@@ -53,7 +55,9 @@ namespace sigmaengine { namespace dapp {
       dapp_trx_fee_vote_object_type    = (DAPP_SPACE_ID << 8) + 5,
 
       dapp_nsta602_object_type         = (DAPP_SPACE_ID << 8) + 6,
-      dapp_nsta602_owner_object_type   = (DAPP_SPACE_ID << 8) + 7
+      dapp_nsta602_owner_object_type   = (DAPP_SPACE_ID << 8) + 7,
+
+      dapp_feed_object_type            = (DAPP_SPACE_ID << 8) + 8
    };
 
    class dapp_object : public object< dapp_object_type, dapp_object >
@@ -83,7 +87,7 @@ namespace sigmaengine { namespace dapp {
    public:
       template< typename Constructor, typename Allocator >
       dapp_comment_object(Constructor&& c, allocator< Allocator > a)
-         :category(a), parent_permlink(a), permlink(a), title(a), body(a), json_metadata(a) //, beneficiaries(a)
+         :category(a), parent_permlink(a), permlink(a) //, beneficiaries(a)
       {
          c(*this);
       }
@@ -97,9 +101,10 @@ namespace sigmaengine { namespace dapp {
       account_name_type author;
       shared_string     permlink;
 
-      shared_string     title;
-      shared_string     body;
-      shared_string     json_metadata;
+      /// title, body and metadata live in the plugin's dapp_content_store, see dapp_plugin::content_store()
+      dapp_content_ref  title;
+      dapp_content_ref  body;
+      dapp_content_ref  json_metadata;
       time_point_sec    last_update;
       time_point_sec    created;
       time_point_sec    active; ///< the last time this post was "touched" by voting or reply
@@ -236,6 +241,32 @@ namespace sigmaengine { namespace dapp {
    };
    typedef oid< dapp_nsta602_owner_object > dapp_nsta602_owner_id_type;
 
+   /**
+    * One entry per top level post, holding just what the dapp feeds sort by.
+    * It is a view of dapp_comment_object that the dapp plugin refreshes at the end of
+    * each block for the posts touched in it, so feed queries walk only root posts of
+    * one dapp instead of filtering every comment.
+    */
+   class dapp_feed_object : public object< dapp_feed_object_type, dapp_feed_object >
+   {
+      public:
+         template< typename Constructor, typename Allocator >
+         dapp_feed_object( Constructor&& c, allocator< Allocator > a )
+         {
+            c( *this );
+         }
+
+         id_type                 id;
+         dapp_name_type          dapp_name;
+         dapp_comment_id_type    comment;
+         account_name_type       author;
+         time_point_sec          created;
+         time_point_sec          active;
+         int64_t                 trending = 0; ///< like_count - dislike_count + children of the post
+   };
+
+   typedef oid< dapp_feed_object > dapp_feed_id_type;
+
    struct by_name;
    struct by_owner;
 
@@ -271,6 +302,11 @@ namespace sigmaengine { namespace dapp {
    struct by_permlink_newest;
    struct by_nsta602_owner;
 
+   struct by_comment;
+   struct by_dapp_created;
+   struct by_dapp_trending;
+   struct by_dapp_author_created;
+
    typedef multi_index_container <
       dapp_object,
       indexed_by <
@@ -474,14 +510,14 @@ namespace sigmaengine { namespace dapp {
             ,
             composite_key_compare< std::less< dapp_name_type >, std::greater< dapp_nsta602_id_type > >
          >,
-         ordered_unique < tag < by_author >,
+         ranked_unique < tag < by_author >,
             composite_key< dapp_nsta602_object,
                member < dapp_nsta602_object, account_name_type, &dapp_nsta602_object::author >,
                member < dapp_nsta602_object, dapp_nsta602_id_type, &dapp_nsta602_object::id >
             >,
             composite_key_compare< std::less< account_name_type >, std::less< dapp_nsta602_id_type > >
          >,
-         ordered_unique < tag < by_author_newest >,
+         ranked_unique < tag < by_author_newest >,
             composite_key< dapp_nsta602_object,
                member < dapp_nsta602_object, account_name_type, &dapp_nsta602_object::author >,
                member < dapp_nsta602_object, dapp_nsta602_id_type, &dapp_nsta602_object::id >
@@ -500,20 +536,24 @@ namespace sigmaengine { namespace dapp {
       allocator < dapp_nsta602_object >
    > dapp_nsta602_index;
 
+   /**
+    * by_owner/by_owner_newest here and by_author/by_author_newest above are ranked so dapp_api can
+    * jump to the n-th item of an owner's or author's collection in O(log n) instead of stepping.
+    */
    typedef multi_index_container <
       dapp_nsta602_owner_object,
       indexed_by <
          ordered_unique < tag < by_id >,
             member < dapp_nsta602_owner_object, dapp_nsta602_owner_id_type, &dapp_nsta602_owner_object::id >
          >,
-         ordered_unique < tag < by_owner >,
+         ranked_unique < tag < by_owner >,
             composite_key< dapp_nsta602_owner_object,
                member< dapp_nsta602_owner_object, account_name_type, &dapp_nsta602_owner_object::owner >,
                member < dapp_nsta602_owner_object, dapp_nsta602_owner_id_type, &dapp_nsta602_owner_object::id >
             >,
             composite_key_compare< std::less< account_name_type >, std::less< dapp_nsta602_owner_id_type > >
          >,
-         ordered_unique < tag < by_owner_newest >,
+         ranked_unique < tag < by_owner_newest >,
             composite_key< dapp_nsta602_owner_object,
                member< dapp_nsta602_owner_object, account_name_type, &dapp_nsta602_owner_object::owner >,
                member < dapp_nsta602_owner_object, dapp_nsta602_owner_id_type, &dapp_nsta602_owner_object::id >
@@ -561,6 +601,45 @@ namespace sigmaengine { namespace dapp {
       allocator < dapp_nsta602_owner_object >
    > dapp_nsta602_owner_index;
 
+   typedef multi_index_container <
+      dapp_feed_object,
+      indexed_by <
+         ordered_unique < tag < by_id >,
+            member < dapp_feed_object, dapp_feed_id_type, &dapp_feed_object::id >
+         >,
+         ordered_unique < tag < by_comment >,
+            member < dapp_feed_object, dapp_comment_id_type, &dapp_feed_object::comment >
+         >,
+         ordered_unique < tag < by_dapp_created >,
+            composite_key< dapp_feed_object,
+               member< dapp_feed_object, dapp_name_type, &dapp_feed_object::dapp_name >,
+               member< dapp_feed_object, time_point_sec, &dapp_feed_object::created >,
+               member< dapp_feed_object, dapp_comment_id_type, &dapp_feed_object::comment >
+            >,
+            composite_key_compare< std::less< dapp_name_type >, std::greater< time_point_sec >, std::greater< dapp_comment_id_type > >
+         >,
+         ordered_unique < tag < by_dapp_trending >,
+            composite_key< dapp_feed_object,
+               member< dapp_feed_object, dapp_name_type, &dapp_feed_object::dapp_name >,
+               member< dapp_feed_object, int64_t, &dapp_feed_object::trending >,
+               member< dapp_feed_object, time_point_sec, &dapp_feed_object::active >,
+               member< dapp_feed_object, dapp_comment_id_type, &dapp_feed_object::comment >
+            >,
+            composite_key_compare< std::less< dapp_name_type >, std::greater< int64_t >, std::greater< time_point_sec >, std::greater< dapp_comment_id_type > >
+         >,
+         ordered_unique < tag < by_dapp_author_created >,
+            composite_key< dapp_feed_object,
+               member< dapp_feed_object, dapp_name_type, &dapp_feed_object::dapp_name >,
+               member< dapp_feed_object, account_name_type, &dapp_feed_object::author >,
+               member< dapp_feed_object, time_point_sec, &dapp_feed_object::created >,
+               member< dapp_feed_object, dapp_comment_id_type, &dapp_feed_object::comment >
+            >,
+            composite_key_compare< std::less< dapp_name_type >, std::less< account_name_type >, std::greater< time_point_sec >, std::greater< dapp_comment_id_type > >
+         >
+      >,
+      allocator < dapp_feed_object >
+   > dapp_feed_index;
+
 } } // namespace sigmaengine::dapp
 
 FC_REFLECT( sigmaengine::dapp::dapp_object,
@@ -658,4 +737,15 @@ CHAINBASE_SET_INDEX_TYPE( sigmaengine::dapp::dapp_trx_fee_vote_object, sigmaengi
 CHAINBASE_SET_INDEX_TYPE( sigmaengine::dapp::dapp_nsta602_object, sigmaengine::dapp::dapp_nsta602_index )
 CHAINBASE_SET_INDEX_TYPE( sigmaengine::dapp::dapp_nsta602_owner_object, sigmaengine::dapp::dapp_nsta602_owner_index )
 
+FC_REFLECT( sigmaengine::dapp::dapp_feed_object,
+   ( id )
+   ( dapp_name )
+   ( comment )
+   ( author )
+   ( created )
+   ( active )
+   ( trending )
+)
+CHAINBASE_SET_INDEX_TYPE( sigmaengine::dapp::dapp_feed_object, sigmaengine::dapp::dapp_feed_index )
+
 
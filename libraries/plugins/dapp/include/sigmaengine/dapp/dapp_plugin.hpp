@@ -2,6 +2,7 @@
 
 #include <sigmaengine/app/plugin.hpp>
 #include <sigmaengine/dapp/dapp_operations.hpp>
+#include <sigmaengine/dapp/dapp_content_store.hpp>
 
 #define DAPP_PLUGIN_NAME "dapp"
 
@@ -16,8 +17,32 @@ namespace sigmaengine { namespace dapp {
          dapp_plugin( application* app );
 
          std::string plugin_name()const override { return DAPP_PLUGIN_NAME; }
+         virtual void plugin_set_program_options(
+            boost::program_options::options_description& cli,
+            boost::program_options::options_description& cfg ) override;
          virtual void plugin_initialize( const boost::program_options::variables_map& options ) override;
          virtual void plugin_startup() override;
+         virtual void plugin_shutdown() override;
+
+         /// holds comment titles, bodies and metadata referenced by dapp_comment_object
+         dapp_content_store& content_store();
+
+         /**
+          * Replies and deletes update the child count and activity of the direct parent right away.
+          * The change is queued here for the ancestors above it, which are each modified once at
+          * the end of the block no matter how many replies in their subtree changed.
+          * @param parent the comment that was already updated
+          */
+         void queue_ancestor_update( const dapp_comment_object& parent, int32_t children, time_point_sec active );
+
+         /// queued child count changes that are not reflected in c.children yet
+         int32_t pending_children( const dapp_comment_object& c )const;
+
+         /// removes and returns the queued child count changes of a comment that is being deleted
+         int32_t take_pending_children( const dapp_comment_object& c );
+
+         /// refreshes the dapp_feed_object of a top level post at the end of the block
+         void queue_feed_update( dapp_comment_id_type root_comment );
 
          friend class detail::dapp_plugin_impl;
          
@@ -9,27 +9,27 @@ namespace sigmaengine { namespace dapp_history {
             map< uint32_t, applied_operation > get_dapp_history( string dapp_name, uint64_t from, uint32_t limit )const;
             map< uint32_t, applied_operation > get_nsta602_transfer_history( string dapp_name, string author, string unique_id, uint64_t from, uint32_t limit )const;
             map< uint32_t, applied_operation > get_dapp_operation_list( uint64_t from, uint32_t limit )const;
-            sigmaengine::chain::database& database() { return *_app.chain_database(); }
+            map< uint32_t, applied_operation > get_dapp_history_by_type( string dapp_name, vector< string > op_types, uint64_t from, uint32_t limit )const;
+            map< uint32_t, applied_operation > get_dapp_history_by_block( string dapp_name, uint32_t start_block, uint32_t end_block,
+               vector< string > op_types, uint32_t limit )const;
+
+            const dapp_history_log& history_log()const;
 
          private:
             sigmaengine::app::application& _app;
       };
 
-      
+      const dapp_history_log& dapp_history_api_impl::history_log()const {
+         return _app.get_plugin< dapp_history_plugin >( DAPP_HISTORY_PLUGIN_NAME )->history_log();
+      }
+
       map< uint32_t, applied_operation > dapp_history_api_impl::get_dapp_history( string dapp_name, uint64_t from, uint32_t limit )const  {
-         auto _db = _app.chain_database();
          FC_ASSERT( limit <= 10000, "Limit of ${l} is greater than maxmimum allowed", ("l",limit) );
          FC_ASSERT( from >= limit, "From must be greater than limit" );
-         const auto& idx = _db->get_index< dapp_history_index >().indices().get < by_dapp_name >();
-         auto itr = idx.lower_bound( boost::make_tuple( dapp_name, from ) );
-         auto end = idx.upper_bound( boost::make_tuple( dapp_name, std::max( int64_t(0), int64_t( itr->sequence ) - limit ) ) );
 
          map<uint32_t, applied_operation> result;
-         while( itr != end )
-         {
-            result[itr->sequence] = _db->get(itr->op);
-            ++itr;
-         }
+         for( auto& record : history_log().get_dapp_history( dapp_name, from, limit ) )
+            result[record.sequence] = std::move( record.op );
          return result;
       }
 
@@ -38,36 +38,42 @@ namespace sigmaengine { namespace dapp_history {
          FC_ASSERT( limit <= 10000, "Limit of ${l} is greater than maxmimum allowed", ("l",limit) );
          FC_ASSERT( from >= limit, "From must be greater than limit" );
 
-         auto _db = _app.chain_database();
-      
-         const auto & idx = _db->get_index< dapp_history_index >().indices().get< by_transaction >();
-         
-         auto itr = idx.lower_bound( from );
-         auto end = idx.upper_bound( std::max( int64_t(0), int64_t(itr->all_sequence)-limit ) );
-
          map<uint32_t, applied_operation> result;
-         while( itr != end )
-         {
-            result[itr->all_sequence] = _db->get(itr->op);
-            ++itr;
-         }
+         for( auto& record : history_log().get_operation_list( from, limit ) )
+            result[record.all_sequence] = std::move( record.op );
          return result;
       }
 
       map< uint32_t, applied_operation > dapp_history_api_impl::get_nsta602_transfer_history( string dapp_name, string author, string unique_id, uint64_t from, uint32_t limit )const  {
-         auto _db = _app.chain_database();
          FC_ASSERT( limit <= 10000, "Limit of ${l} is greater than maxmimum allowed", ("l",limit) );
          FC_ASSERT( from >= limit, "From must be greater than limit" );
-         const auto& idx = _db->get_index< nsta602_transfer_history_index >().indices().get < by_nsta602 >();
-         auto itr = idx.lower_bound( boost::make_tuple( dapp_name, author, unique_id, from ) );
-         auto end = idx.upper_bound( boost::make_tuple( dapp_name, author, unique_id, std::max( int64_t(0), int64_t( itr->sequence ) - limit ) ) );
 
          map<uint32_t, applied_operation> result;
-         while( itr != end )
-         {
-            result[itr->sequence] = _db->get(itr->op);
-            ++itr;
-         }
+         for( auto& record : history_log().get_nsta602_transfer_history( dapp_name, author, unique_id, from, limit ) )
+            result[record.nsta602_sequence] = std::move( record.op );
+         return result;
+      }
+
+      map< uint32_t, applied_operation > dapp_history_api_impl::get_dapp_history_by_type( string dapp_name, vector< string > op_types, uint64_t from, uint32_t limit )const  {
+         FC_ASSERT( limit <= 10000, "Limit of ${l} is greater than maxmimum allowed", ("l",limit) );
+         FC_ASSERT( !op_types.empty(), "At least one operation type is required" );
+
+         fc::flat_set< string > types( op_types.begin(), op_types.end() );
+         map<uint32_t, applied_operation> result;
+         for( auto& record : history_log().get_dapp_history( dapp_name, from, limit, types ) )
+            result[record.sequence] = std::move( record.op );
+         return result;
+      }
+
+      map< uint32_t, applied_operation > dapp_history_api_impl::get_dapp_history_by_block( string dapp_name, uint32_t start_block, uint32_t end_block,
+         vector< string > op_types, uint32_t limit )const  {
+         FC_ASSERT( limit <= 10000, "Limit of ${l} is greater than maxmimum allowed", ("l",limit) );
+         FC_ASSERT( start_block <= end_block, "start_block must not be greater than end_block" );
+
+         fc::flat_set< string > types( op_types.begin(), op_types.end() );
+         map<uint32_t, applied_operation> result;
+         for( auto& record : history_log().get_dapp_history_by_block( dapp_name, start_block, end_block, types, limit ) )
+            result[record.sequence] = std::move( record.op );
          return result;
       }
 
@@ -79,23 +85,27 @@ namespace sigmaengine { namespace dapp_history {
 
    void dapp_history_api::on_api_startup() {}
 
+   // the history lives in the dapp history log, which has its own lock, so none of these take the database lock
    map< uint32_t, applied_operation > dapp_history_api::get_dapp_history( string dapp_name, uint64_t from, uint32_t limit ) const {
-      return _my->database().with_read_lock( [ & ]() {
-         return _my->get_dapp_history( dapp_name, from, limit );
-      });
+      return _my->get_dapp_history( dapp_name, from, limit );
    }
 
    map< uint32_t, applied_operation > dapp_history_api::get_dapp_operation_list( uint64_t from, uint32_t limit )const
    {
-      return _my->database().with_read_lock( [ & ]() {
-         return _my->get_dapp_operation_list( from, limit );
-      });
+      return _my->get_dapp_operation_list( from, limit );
    }
 
    map< uint32_t, applied_operation > dapp_history_api::get_nsta602_transfer_history( string dapp_name, string author, string unique_id, uint64_t from, uint32_t limit ) const {
-      return _my->database().with_read_lock( [ & ]() {
-         return _my->get_nsta602_transfer_history( dapp_name, author, unique_id, from, limit );
-      });
+      return _my->get_nsta602_transfer_history( dapp_name, author, unique_id, from, limit );
+   }
+
+   map< uint32_t, applied_operation > dapp_history_api::get_dapp_history_by_type( string dapp_name, vector< string > op_types, uint64_t from, uint32_t limit )const {
+      return _my->get_dapp_history_by_type( dapp_name, op_types, from, limit );
+   }
+
+   map< uint32_t, applied_operation > dapp_history_api::get_dapp_history_by_block( string dapp_name, uint32_t start_block, uint32_t end_block,
+      vector< string > op_types, uint32_t limit )const {
+      return _my->get_dapp_history_by_block( dapp_name, start_block, end_block, op_types, limit );
    }
 
 } } //namespace sigmaengine::dapp_history
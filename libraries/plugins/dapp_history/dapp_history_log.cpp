@@ -0,0 +1,605 @@
+#include <sigmaengine/dapp_history/dapp_history_log.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include <sys/stat.h>
+
+#define HISTORY_READ  (std::ios::in | std::ios::binary)
+#define HISTORY_WRITE (std::ios::out | std::ios::binary | std::ios::app)
+
+namespace sigmaengine { namespace dapp_history {
+
+   namespace detail {
+      /// each record is [uint32 size][packed dapp_history_record]
+      static const uint64_t record_header_size = sizeof( uint32_t );
+
+      /// the file is compacted once its dead prefix is at least this large and larger than the live part
+      static const uint64_t compact_threshold = 64 * 1024 * 1024;
+
+      /// the state file next to the log is [uint32 head block][uint32 generation][uint32 truncated block]
+      struct log_state
+      {
+         uint32_t head_block = 0;
+         uint32_t generation = 0;
+         uint32_t truncated_block = 0;
+      };
+
+      /// positions of a run of records with consecutive sequence numbers, oldest first
+      struct history_column
+      {
+         uint32_t                first_sequence = 0;
+         std::deque< uint32_t >  blocks;
+         std::deque< uint16_t >  types;
+         std::deque< uint64_t >  offsets;
+
+         bool empty()const { return blocks.empty(); }
+         uint32_t next_sequence()const { return first_sequence + blocks.size(); }
+
+         void push_back( uint32_t sequence, uint32_t block, uint16_t type, uint64_t offset )
+         {
+            if( empty() )
+               first_sequence = sequence;
+            blocks.push_back( block );
+            types.push_back( type );
+            offsets.push_back( offset );
+         }
+
+         void pop_back()
+         {
+            blocks.pop_back();
+            types.pop_back();
+            offsets.pop_back();
+         }
+
+         void pop_front()
+         {
+            blocks.pop_front();
+            types.pop_front();
+            offsets.pop_front();
+            ++first_sequence;
+         }
+      };
+
+      /// the per dapp and per nsta602 item columns a record of the file was indexed in
+      struct record_columns
+      {
+         history_column* dapp = nullptr;
+         history_column* nsta602 = nullptr;
+      };
+
+      typedef std::tuple< dapp_name_type, account_name_type, std::string > nsta602_key;
+
+      class dapp_history_log_impl
+      {
+         public:
+            fc::path                                        file;
+            fc::path                                        state_file;
+            bool                                            read_only = false;
+            std::fstream                                    read_stream;
+            std::fstream                                    write_stream;
+            uint64_t                                        end = 0;
+            uint32_t                                        last_block = 0;
+
+            /// the generation is bumped by every truncation, so a reader knows when records it indexed are gone
+            log_state                                       state;
+            /// the file a reader indexed, a compaction replaces it
+            ino_t                                           inode = 0;
+
+            /// every record in file order, so truncation and pruning only walk this column
+            history_column                                  all;
+            std::deque< record_columns >                    all_columns;
+            std::map< dapp_name_type, history_column >      by_dapp;
+            std::map< nsta602_key, history_column >         by_nsta602;
+
+            std::vector< std::string >                      type_names;
+            std::map< std::string, uint16_t >               type_ids;
+            mutable std::mutex                              mutex;
+
+            uint16_t type_id( const std::string& name )
+            {
+               auto itr = type_ids.find( name );
+               if( itr != type_ids.end() )
+                  return itr->second;
+
+               FC_ASSERT( type_names.size() < std::numeric_limits< uint16_t >::max(), "Too many dapp operation types" );
+               uint16_t id = type_names.size();
+               type_names.push_back( name );
+               type_ids[ name ] = id;
+               return id;
+            }
+
+            void index( const dapp_history_record& record, uint64_t offset )
+            {
+               uint16_t type = type_id( record.op_type );
+               record_columns columns;
+
+               columns.dapp = &by_dapp[ record.dapp_name ];
+               columns.dapp->push_back( record.sequence, record.op.block, type, offset );
+
+               if( record.nsta602_author != account_name_type() )
+               {
+                  columns.nsta602 = &by_nsta602[ nsta602_key( record.dapp_name, record.nsta602_author, record.nsta602_unique_id ) ];
+                  columns.nsta602->push_back( record.nsta602_sequence, record.op.block, type, offset );
+               }
+
+               all.push_back( record.all_sequence, record.op.block, type, offset );
+               all_columns.push_back( columns );
+               last_block = record.op.block;
+            }
+
+            void clear_index()
+            {
+               all = history_column();
+               all_columns.clear();
+               by_dapp.clear();
+               by_nsta602.clear();
+               last_block = 0;
+               end = 0;
+            }
+
+            /// drops the records of block_num and of every later block from the index, returns the offset the first of them had
+            uint64_t drop_back( uint32_t block_num )
+            {
+               uint64_t new_end = end;
+               while( !all.empty() && all.blocks.back() >= block_num )
+               {
+                  auto& columns = all_columns.back();
+                  columns.dapp->pop_back();
+                  if( columns.nsta602 != nullptr )
+                     columns.nsta602->pop_back();
+
+                  new_end = all.offsets.back();
+                  all.pop_back();
+                  all_columns.pop_back();
+               }
+               last_block = std::min( last_block, block_num - 1 );
+               return new_end;
+            }
+
+            void open_streams()
+            {
+               if( !read_only )
+                  write_stream.open( file.generic_string().c_str(), HISTORY_WRITE );
+               read_stream.open( file.generic_string().c_str(), HISTORY_READ );
+               FC_ASSERT( ( read_only || write_stream ) && read_stream, "Unable to open dapp history file ${f}", ("f", file) );
+            }
+
+            void close_streams()
+            {
+               if( write_stream.is_open() )
+               {
+                  write_stream.flush();
+                  write_stream.close();
+               }
+               if( read_stream.is_open() )
+                  read_stream.close();
+            }
+
+            /**
+             * Indexes the records from end to the end of the file.  The writer cuts off a record torn by
+             * a crash, a reader stops before a record the writer is still appending.
+             */
+            void scan()
+            {
+               uint64_t file_size = fc::file_size( file );
+               uint64_t pos = end;
+               std::vector< char > data;
+
+               std::fstream in( file.generic_string().c_str(), HISTORY_READ );
+               while( pos + record_header_size <= file_size )
+               {
+                  uint32_t size = 0;
+                  in.seekg( pos );
+                  in.read( (char*)&size, sizeof( size ) );
+                  if( !in || pos + record_header_size + size > file_size )
+                     break;
+
+                  data.resize( size );
+                  in.read( data.data(), size );
+                  if( !in )
+                     break;
+
+                  dapp_history_record record;
+                  try
+                  {
+                     record = fc::raw::unpack< dapp_history_record >( data );
+                  }
+                  catch( const fc::exception& )
+                  {
+                     break;
+                  }
+
+                  index( record, pos );
+                  pos += record_header_size + size;
+               }
+
+               if( pos != file_size && !read_only )
+               {
+                  wlog( "Truncating incomplete record at the end of ${f} (${p} of ${s} bytes are valid)",
+                        ("f", file)("p", pos)("s", file_size) );
+                  fc::resize_file( file, pos );
+               }
+               end = pos;
+            }
+
+            bool read_state( log_state& result )const
+            {
+               std::fstream in( state_file.generic_string().c_str(), HISTORY_READ );
+               in.read( (char*)&result, sizeof( result ) );
+               return bool( in );
+            }
+
+            void write_state()
+            {
+               std::fstream out( state_file.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+               out.write( (const char*)&state, sizeof( state ) );
+               out.flush();
+               FC_ASSERT( out, "Unable to write dapp history state ${f}", ("f", state_file) );
+            }
+
+            /// rebuilds the index of a reader from the file the writer has now
+            void reindex()
+            {
+               struct stat st;
+               if( ::stat( file.generic_string().c_str(), &st ) != 0 )
+                  return;
+
+               read_state( state );
+               if( read_stream.is_open() )
+                  read_stream.close();
+               clear_index();
+               inode = st.st_ino;
+               read_stream.open( file.generic_string().c_str(), HISTORY_READ );
+               scan();
+            }
+
+            /**
+             * Catches a reader up with the writer.  Records the writer appended are indexed, the records
+             * of blocks a single truncation dropped are indexed again from the file, and the index is
+             * rebuilt after a compaction or when the reader missed several truncations.
+             */
+            void refresh()
+            {
+               struct stat st;
+               log_state current;
+               if( ::stat( file.generic_string().c_str(), &st ) != 0 || !read_state( current ) )
+                  return;
+
+               if( !read_stream.is_open() || st.st_ino != inode
+                  || ( current.generation != state.generation && current.generation != state.generation + 1 ) )
+               {
+                  reindex();
+                  return;
+               }
+
+               if( current.generation != state.generation )
+                  end = drop_back( current.truncated_block );
+               if( uint64_t( st.st_size ) < end )
+               {
+                  reindex();
+                  return;
+               }
+
+               state = current;
+               if( uint64_t( st.st_size ) > end )
+                  scan();
+            }
+
+            dapp_history_record read( uint64_t offset )
+            {
+               uint32_t size = 0;
+               read_stream.clear();
+               read_stream.seekg( offset );
+               read_stream.read( (char*)&size, sizeof( size ) );
+               FC_ASSERT( read_stream && offset + record_header_size + size <= end,
+                          "Unable to read dapp history record", ("offset", offset)("end", end) );
+
+               std::vector< char > data( size );
+               read_stream.read( data.data(), size );
+               FC_ASSERT( read_stream, "Unable to read dapp history record", ("offset", offset)("size", size) );
+               return fc::raw::unpack< dapp_history_record >( data );
+            }
+
+            /// an empty result means nothing matches, a missing value means everything does
+            fc::optional< fc::flat_set< uint16_t > > type_filter( const fc::flat_set< std::string >& op_types )const
+            {
+               if( op_types.empty() )
+                  return fc::optional< fc::flat_set< uint16_t > >();
+
+               fc::flat_set< uint16_t > ids;
+               for( const auto& name : op_types )
+               {
+                  auto itr = type_ids.find( name );
+                  if( itr != type_ids.end() )
+                     ids.insert( itr->second );
+               }
+               return ids;
+            }
+
+            /// reads the records of column with a sequence of at most from, most recent first
+            std::vector< dapp_history_record > read_back( const history_column& column, uint64_t from, uint32_t count,
+               const fc::optional< fc::flat_set< uint16_t > >& filter )
+            {
+               std::vector< dapp_history_record > result;
+               if( column.empty() || from < column.first_sequence )
+                  return result;
+
+               uint64_t last = std::min< uint64_t >( from, column.next_sequence() - 1 );
+               for( int64_t i = last - column.first_sequence; i >= 0 && result.size() < count; --i )
+               {
+                  if( !filter || filter->find( column.types[ i ] ) != filter->end() )
+                     result.push_back( read( column.offsets[ i ] ) );
+               }
+               return result;
+            }
+
+            void compact()
+            {
+               uint64_t base = all.empty() ? end : all.offsets.front();
+               fc::path tmp = file.generic_string() + ".tmp";
+
+               write_stream.flush();
+               {
+                  std::ofstream out( tmp.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+                  std::vector< char > buffer( 1024 * 1024 );
+                  read_stream.clear();
+                  read_stream.seekg( base );
+                  for( uint64_t pos = base; pos < end; )
+                  {
+                     uint64_t n = std::min< uint64_t >( buffer.size(), end - pos );
+                     read_stream.read( buffer.data(), n );
+                     out.write( buffer.data(), n );
+                     FC_ASSERT( read_stream && out, "Unable to compact dapp history file ${f}", ("f", file) );
+                     pos += n;
+                  }
+               }
+
+               close_streams();
+               fc::rename( tmp, file );
+
+               auto rebase = [base]( history_column& column )
+               {
+                  for( auto& offset : column.offsets )
+                     offset -= base;
+               };
+               rebase( all );
+               for( auto& item : by_dapp )
+                  rebase( item.second );
+               for( auto& item : by_nsta602 )
+                  rebase( item.second );
+               end -= base;
+
+               open_streams();
+               ilog( "Compacted dapp history file ${f}, ${n} bytes are left", ("f", file)("n", end) );
+            }
+      };
+   }
+
+   dapp_history_log::dapp_history_log() : my( new detail::dapp_history_log_impl() ) {}
+
+   dapp_history_log::~dapp_history_log()
+   {
+      close();
+   }
+
+   void dapp_history_log::open( const fc::path& file, bool read_only )
+   {
+      try
+      {
+         std::lock_guard< std::mutex > lock( my->mutex );
+         my->close_streams();
+         my->clear_index();
+         my->state = detail::log_state();
+
+         my->file = file;
+         my->state_file = file.generic_string() + ".state";
+         my->read_only = read_only;
+
+         // a reader never changes the files, the writer may not have created them yet
+         if( read_only )
+         {
+            my->reindex();
+            ilog( "Opened dapp history ${f} read only with ${n} records up to block ${b}",
+                  ("f", file)("n", my->all.blocks.size())("b", my->last_block) );
+            return;
+         }
+
+         if( !fc::exists( file.parent_path() ) )
+            fc::create_directories( file.parent_path() );
+         if( !fc::exists( file ) )
+            std::ofstream( file.generic_string().c_str(), HISTORY_WRITE );
+
+         my->scan();
+         my->open_streams();
+
+         // a log written without the state file is taken to be complete
+         if( !my->read_state( my->state ) )
+         {
+            my->state.head_block = my->last_block;
+            my->write_state();
+         }
+
+         ilog( "Opened dapp history ${f} with ${n} records up to block ${b}, complete up to block ${h}",
+               ("f", file)("n", my->all.blocks.size())("b", my->last_block)("h", my->state.head_block) );
+      }
+      FC_CAPTURE_AND_RETHROW( (file) )
+   }
+
+   void dapp_history_log::close()
+   {
+      std::lock_guard< std::mutex > lock( my->mutex );
+      my->close_streams();
+      my->read_only = false;
+   }
+
+   bool dapp_history_log::is_open()const
+   {
+      return my->read_only || my->write_stream.is_open();
+   }
+
+   uint32_t dapp_history_log::last_block()const
+   {
+      std::lock_guard< std::mutex > lock( my->mutex );
+      if( my->read_only )
+         my->refresh();
+      return my->last_block;
+   }
+
+   uint32_t dapp_history_log::head_block()const
+   {
+      std::lock_guard< std::mutex > lock( my->mutex );
+      if( my->read_only )
+         my->refresh();
+      return my->state.head_block;
+   }
+
+   void dapp_history_log::set_head_block( uint32_t block_num )
+   {
+      std::lock_guard< std::mutex > lock( my->mutex );
+      FC_ASSERT( !my->read_only, "dapp history log is read only" );
+      if( my->state.head_block == block_num )
+         return;
+
+      my->state.head_block = block_num;
+      my->write_state();
+   }
+
+   void dapp_history_log::truncate( uint32_t block_num )
+   {
+      std::lock_guard< std::mutex > lock( my->mutex );
+      FC_ASSERT( !my->read_only, "dapp history log is read only" );
+      if( my->last_block < block_num && my->state.head_block < block_num )
+         return;
+
+      uint64_t new_end = my->drop_back( block_num );
+      if( new_end != my->end )
+      {
+         my->close_streams();
+         fc::resize_file( my->file, new_end );
+         my->end = new_end;
+         my->open_streams();
+      }
+
+      // readers look at the state after the file, so they never index dropped records for good
+      my->state.head_block = std::min( my->state.head_block, block_num - 1 );
+      ++my->state.generation;
+      my->state.truncated_block = block_num;
+      my->write_state();
+   }
+
+   void dapp_history_log::append( std::vector< dapp_history_record >& records )
+   {
+      std::lock_guard< std::mutex > lock( my->mutex );
+      FC_ASSERT( !my->read_only && my->write_stream.is_open(), "dapp history log is not open for writing" );
+
+      for( auto& record : records )
+      {
+         record.sequence = my->by_dapp[ record.dapp_name ].next_sequence();
+         record.all_sequence = my->all.next_sequence();
+         if( record.nsta602_author != account_name_type() )
+            record.nsta602_sequence = my->by_nsta602[ detail::nsta602_key( record.dapp_name, record.nsta602_author, record.nsta602_unique_id ) ].next_sequence();
+
+         auto data = fc::raw::pack( record );
+         uint32_t size = data.size();
+         my->write_stream.write( (const char*)&size, sizeof( size ) );
+         my->write_stream.write( data.data(), data.size() );
+
+         my->index( record, my->end );
+         my->end += detail::record_header_size + size;
+      }
+
+      // readers use a separate stream, so the records have to reach the file before they are indexed for queries
+      my->write_stream.flush();
+      FC_ASSERT( my->write_stream, "Unable to append to dapp history file ${f}", ("f", my->file) );
+   }
+
+   void dapp_history_log::prune( uint32_t block_num )
+   {
+      std::lock_guard< std::mutex > lock( my->mutex );
+      FC_ASSERT( !my->read_only, "dapp history log is read only" );
+      while( !my->all.empty() && my->all.blocks.front() < block_num )
+      {
+         auto& columns = my->all_columns.front();
+         columns.dapp->pop_front();
+         if( columns.nsta602 != nullptr )
+            columns.nsta602->pop_front();
+
+         my->all.pop_front();
+         my->all_columns.pop_front();
+      }
+
+      uint64_t dead = my->all.empty() ? my->end : my->all.offsets.front();
+      if( dead >= detail::compact_threshold && dead > my->end - dead )
+         my->compact();
+   }
+
+   std::vector< dapp_history_record > dapp_history_log::get_dapp_history( const dapp_name_type& dapp_name, uint64_t from, uint32_t limit,
+      const fc::flat_set< std::string >& op_types )const
+   {
+      std::lock_guard< std::mutex > lock( my->mutex );
+      if( my->read_only )
+         my->refresh();
+      auto itr = my->by_dapp.find( dapp_name );
+      if( itr == my->by_dapp.end() )
+         return std::vector< dapp_history_record >();
+
+      auto filter = my->type_filter( op_types );
+      // without a filter the range [from - limit, from] is returned, as it was by the chain index
+      return my->read_back( itr->second, from, filter ? limit : limit + 1, filter );
+   }
+
+   std::vector< dapp_history_record > dapp_history_log::get_dapp_history_by_block( const dapp_name_type& dapp_name, uint32_t start_block, uint32_t end_block,
+      const fc::flat_set< std::string >& op_types, uint32_t limit )const
+   {
+      std::vector< dapp_history_record > result;
+
+      std::lock_guard< std::mutex > lock( my->mutex );
+      if( my->read_only )
+         my->refresh();
+      auto itr = my->by_dapp.find( dapp_name );
+      if( itr == my->by_dapp.end() )
+         return result;
+
+      const auto& column = itr->second;
+      auto filter = my->type_filter( op_types );
+      auto first = std::lower_bound( column.blocks.begin(), column.blocks.end(), start_block );
+      for( size_t i = first - column.blocks.begin(); i < column.blocks.size() && column.blocks[ i ] <= end_block && result.size() < limit; ++i )
+      {
+         if( !filter || filter->find( column.types[ i ] ) != filter->end() )
+            result.push_back( my->read( column.offsets[ i ] ) );
+      }
+      return result;
+   }
+
+   std::vector< dapp_history_record > dapp_history_log::get_operation_list( uint64_t from, uint32_t limit )const
+   {
+      std::lock_guard< std::mutex > lock( my->mutex );
+      if( my->read_only )
+         my->refresh();
+      return my->read_back( my->all, from, limit + 1, fc::optional< fc::flat_set< uint16_t > >() );
+   }
+
+   std::vector< dapp_history_record > dapp_history_log::get_nsta602_transfer_history( const dapp_name_type& dapp_name, const account_name_type& author,
+      const std::string& unique_id, uint64_t from, uint32_t limit )const
+   {
+      std::lock_guard< std::mutex > lock( my->mutex );
+      if( my->read_only )
+         my->refresh();
+      auto itr = my->by_nsta602.find( detail::nsta602_key( dapp_name, author, unique_id ) );
+      if( itr == my->by_nsta602.end() )
+         return std::vector< dapp_history_record >();
+
+      return my->read_back( itr->second, from, limit + 1, fc::optional< fc::flat_set< uint16_t > >() );
+   }
+
+} } // sigmaengine::dapp_history
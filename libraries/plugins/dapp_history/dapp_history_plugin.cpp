@@ -1,11 +1,8 @@
 #include <sigmaengine/dapp_history/dapp_history_plugin.hpp>
 #include <sigmaengine/dapp_history/dapp_impacted.hpp>
-#include <sigmaengine/dapp_history/dapp_history_objects.hpp>
 #include <sigmaengine/dapp_history/dapp_history_api.hpp>
 
 #include <sigmaengine/chain/database.hpp>
-#include <sigmaengine/chain/index.hpp>
-#include <sigmaengine/chain/history_object.hpp>
 
 namespace sigmaengine { namespace dapp_history {
 
@@ -18,187 +15,275 @@ namespace sigmaengine { namespace dapp_history {
             sigmaengine::chain::database& database() {
                return _self.database();
             }
+            void on_pre_apply_block( const signed_block& b );
             void on_pre_operation( const operation_notification& note );
+            void on_applied_block( const signed_block& b );
+            void write_late_records();
+            void reconcile();
+
+            dapp_history_log                    _log;
+            uint32_t                            _retention_blocks = 0;
 
          private:
-            dapp_history_plugin&  _self;
+            void add_records( const operation_notification& note, std::vector< dapp_history_record >& records );
+            void write_records( std::vector< dapp_history_record >& records );
+            void record_block( const signed_block& b );
+
+            dapp_history_plugin&                _self;
+
+            /// records of the block being applied, only written once the block is applied
+            std::vector< dapp_history_record >  _block_records;
+            fc::time_point_sec                  _block_time;
+            bool                                _in_block = false;
+
+            /// virtual operations other applied_block handlers push once the last block is applied
+            std::vector< dapp_history_record >  _late_records;
+            uint32_t                            _applied_block_num = 0;
+
+            bool                                _reconciled = false;
       };  //class dapp_history_plugin_impl
 
-      struct operation_visitor {
-         operation_visitor( database& db, const operation_notification& note, const operation_object*& n, dapp_name_type _name )
-            :_db( db ), _note( note ), _new_obj( n ), dapp_name( _name ) {}
-
-         typedef void result_type;
-
-         database& _db;
-         const operation_notification& _note;
-         const operation_object*& _new_obj;
-         dapp_name_type dapp_name;
-
-         template<typename Op>
-         void operator()( Op&& )const {
-            if( !_new_obj ) {
-               const auto& idx = _db.get_index< operation_index >().indices().get< by_location >();
-               auto itr = idx.lower_bound( boost::make_tuple( _note.block, _note.trx_in_block, _note.op_in_trx, _note.virtual_op ) );
-               if( itr != idx.end() && itr->block == _note.block 
-                  && itr->trx_in_block == _note.trx_in_block && itr->op_in_trx == _note.op_in_trx
-                  && itr->virtual_op == _note.virtual_op ) {
-                  _new_obj = &( *itr );
-               } else {
-                  while( itr != idx.end() && itr->block == _note.block ){
-                     if(itr->trx_in_block == _note.trx_in_block && itr->op_in_trx == _note.op_in_trx && itr->virtual_op == _note.virtual_op) {
-                        _new_obj = &( *itr );
-                        break;
-                     }
-                     itr++;
-                  }
-               }
-
-               if( !_new_obj ) {
-                  _new_obj = &_db.create< operation_object >( [&]( operation_object& object ) {
-                     object.trx_id       = _note.trx_id;
-                     object.block        = _note.block;
-                     object.trx_in_block = _note.trx_in_block;
-                     object.op_in_trx    = _note.op_in_trx;
-                     object.virtual_op   = _note.virtual_op;
-                     object.timestamp    = _db.head_block_time();
-                     auto size = fc::raw::pack_size( _note.op );
-                     object.serialized_op.resize( size );
-                     fc::datastream< char* > ds( object.serialized_op.data(), size );
-                     fc::raw::pack( ds, _note.op );
-                  });
-               }
-            }
+      /// fills author and unique_id when op is a custom_json_dapp_operation carrying an nsta602 transfer
+      bool get_nsta602_transfer( const operation& op, account_name_type& author, string& unique_id ) {
+         if( op.which() != operation::tag< custom_json_dapp_operation >::value )
+            return false;
 
-            const auto& hist_idx = _db.get_index< dapp_history_index >().indices().get< by_dapp_name >();
-            auto hist_itr = hist_idx.lower_bound( boost::make_tuple( dapp_name, uint32_t(-1) ) );
-            uint32_t sequence = 0;
-            if( hist_itr != hist_idx.end() && hist_itr->dapp_name == dapp_name )
-               sequence = hist_itr->sequence + 1;
+         static const string transfer_op_name = "nsta602_transfer";
+         static const string extransfer_op_name = "nsta602_extransfer";
 
-            uint32_t all_sequence = 0;
-            const auto & idx = _db.get_index< dapp_history_index >().indices().get< by_transaction >();
-            auto itr = idx.lower_bound( uint32_t(-1) );
-            if( itr != idx.end() )
+         auto& custom_op = op.get< custom_json_dapp_operation >();
+         try {
+            auto var = fc::json::from_string( custom_op.json );
+            auto ar = var.get_array();
+            if( ( ar[0].is_uint64() && ar[0].as_uint64() == dapp_operation::tag< nsta602_transfer_operation >::value )
+               || ( ar[0].as_string() == transfer_op_name ) )
+            {
+               auto inner_op = ar[1].as< nsta602_transfer_operation >();
+               author = inner_op.author;
+               unique_id = inner_op.unique_id;
+               return true;
+            }
+            else if( ( ar[0].is_uint64() && ar[0].as_uint64() == dapp_operation::tag< nsta602_extransfer_operation >::value )
+               || ( ar[0].as_string() == extransfer_op_name ) )
             {
-               all_sequence = itr->all_sequence + 1;
+               auto inner_op = ar[1].as< nsta602_extransfer_operation >();
+               author = inner_op.author;
+               unique_id = inner_op.unique_id;
+               return true;
             }
+         }
+         catch( const fc::exception& ) {
+         }
+         return false;
+      }
 
-            _db.create< dapp_history_object >( [&]( dapp_history_object& object ) {
-               object.dapp_name  = dapp_name;
-               object.sequence   = sequence;
-               object.all_sequence   = all_sequence;
-               object.op         = _new_obj->id;
-            });
+      void dapp_history_plugin_impl::write_records( std::vector< dapp_history_record >& records ) {
+         if( !records.empty() ) {
+            _log.append( records );
+            records.clear();
+         }
+      }
 
+      void dapp_history_plugin_impl::write_late_records() {
+         write_records( _late_records );
+         if( _applied_block_num > 0 )
+            _log.set_head_block( _applied_block_num );
+      }
 
-            if ( _note.op.which() == operation::tag<custom_json_dapp_operation>::value )
-            {
-               const std::string& type_name = fc::get_typename< nsta602_transfer_operation >::name();
-               
-               auto start = type_name.find_last_of( ':' ) + 1;
-               auto end   = type_name.find_last_of( '_' );
-               string transfer_op_name  = type_name.substr( start, end - start );
-
-               const std::string& extype_name = fc::get_typename< nsta602_extransfer_operation >::name();
-               auto exstart = extype_name.find_last_of( ':' ) + 1;
-               auto exend   = extype_name.find_last_of( '_' );
-               string extransfer_op_name  = extype_name.substr( exstart, exend - exstart );
-               
-               auto& custom_op = _note.op.get< custom_json_dapp_operation >();
-               try{
-                  auto var = fc::json::from_string( custom_op.json );
-                  auto ar = var.get_array();
-                  if( ( ar[0].is_uint64() && ar[0].as_uint64() == dapp_operation::tag< nsta602_transfer_operation >::value ) 
-                     || ( ar[0].as_string() == transfer_op_name ) ) 
-                  {
-                     const nsta602_transfer_operation inner_op = ar[1].as< nsta602_transfer_operation >();
-                     nsta602_transfer_operation temp_op = inner_op;
-                  
-                     const auto& idx = _db.get_index< nsta602_transfer_history_index >().indices().get< by_nsta602 >();
-                     auto itr = idx.lower_bound( boost::make_tuple( dapp_name, temp_op.author, temp_op.unique_id, uint32_t(-1) ) );
-                     uint32_t sequence = 0;
-                     if( itr != idx.end() && itr->dapp_name == dapp_name && itr->author == temp_op.author && to_string(itr->unique_id) == temp_op.unique_id )
-                        sequence = itr->sequence + 1;
-
-                     _db.create< nsta602_transfer_history_object >( [&]( nsta602_transfer_history_object& object ) {
-                        object.dapp_name  = dapp_name;
-                        object.author     = temp_op.author;
-                        from_string(object.unique_id, temp_op.unique_id);
-                        object.sequence   = sequence;
-                        object.op         = _new_obj->id;
-                     });
-                      
-                  }
-                  else if (( ar[0].is_uint64() && ar[0].as_uint64() == dapp_operation::tag< nsta602_extransfer_operation >::value ) 
-                           || ( ar[0].as_string() == extransfer_op_name ) )
-                  {
-                     const nsta602_extransfer_operation inner_op = ar[1].as< nsta602_extransfer_operation >();
-                     nsta602_extransfer_operation temp_op = inner_op;
-
-                     const auto& idx = _db.get_index< nsta602_transfer_history_index >().indices().get< by_nsta602 >();
-                     auto itr = idx.lower_bound( boost::make_tuple( dapp_name, temp_op.author, temp_op.unique_id, uint32_t(-1) ) );
-                     uint32_t sequence = 0;
-                     if( itr != idx.end() && itr->dapp_name == dapp_name && itr->author == temp_op.author && to_string(itr->unique_id) == temp_op.unique_id )
-                        sequence = itr->sequence + 1;
-
-                     _db.create< nsta602_transfer_history_object >( [&]( nsta602_transfer_history_object& object ) {
-                        object.dapp_name  = dapp_name;
-                        object.author     = temp_op.author;
-                        from_string(object.unique_id, temp_op.unique_id);
-                        object.sequence   = sequence;
-                        object.op         = _new_obj->id;
-                     });
-                  }
-                  
-               }
-               catch( const fc::exception& ) {
-                  
-               }
-            }
+      /**
+       * Brings the log in line with the chain head the node starts from.  Records past the last complete
+       * block belong to a block whose late records a crash lost or to blocks the chain no longer has, and
+       * the operations of the blocks applied since are recorded again from the block log.  Their virtual
+       * operations are not in the blocks, only a replay records them.
+       */
+      void dapp_history_plugin_impl::reconcile() {
+         if( _reconciled )
+            return;
+         _reconciled = true;
+
+         auto& db = database();
+         uint32_t head = db.head_block_num();
+         if( _log.head_block() == 0 && _log.last_block() == 0 ) {
+            // a new log starts with the next block
+            _log.set_head_block( head );
+            return;
+         }
+
+         _log.truncate( std::min( _log.head_block(), head ) + 1 );
+         if( _log.head_block() == head )
+            return;
 
-         
-            
+         wlog( "Recording the operations of blocks ${f} to ${t} in the dapp history, use --replay-blockchain to also record their virtual operations",
+               ("f", _log.head_block() + 1)("t", head) );
+         for( uint32_t block_num = _log.head_block() + 1; block_num <= head; ++block_num ) {
+            auto b = db.fetch_block_by_number( block_num );
+            FC_ASSERT( b.valid(), "Block ${b} is missing", ("b", block_num) );
+            record_block( *b );
          }
-      };  // struct operation_visitor
 
-      void dapp_history_plugin_impl::on_pre_operation( const operation_notification& note ){
-         flat_set< dapp_name_type > impacted;
-         sigmaengine::chain::database& db = database();
+         if( _retention_blocks > 0 && head > _retention_blocks )
+            _log.prune( head - _retention_blocks );
+      }
+
+      void dapp_history_plugin_impl::record_block( const signed_block& b ) {
+         uint32_t block_num = b.block_num();
+         _block_time = b.timestamp;
+         for( size_t i = 0; i < b.transactions.size(); ++i ) {
+            const auto& trx = b.transactions[ i ];
+            auto trx_id = trx.id();
+            for( size_t j = 0; j < trx.operations.size(); ++j ) {
+               operation_notification note( trx.operations[ j ] );
+               note.trx_id       = trx_id;
+               note.block        = block_num;
+               note.trx_in_block = i;
+               note.op_in_trx    = j;
+               add_records( note, _block_records );
+            }
+         }
+         write_records( _block_records );
+         _log.set_head_block( block_num );
+      }
+
+      void dapp_history_plugin_impl::on_pre_apply_block( const signed_block& b ) {
+         reconcile();
+
+         // applied_block handlers are done with the last block by now, the records of a block that
+         // failed to apply are dropped
+         write_late_records();
+         _block_records.clear();
+         _block_time = b.timestamp;
+         _in_block = true;
+      }
 
-         const operation_object* new_obj = nullptr;
-         operation_get_impacted_dapp( note.op, db, impacted );
+      void dapp_history_plugin_impl::on_pre_operation( const operation_notification& note ) {
+         // operations of pending transactions are recorded when their block is applied, but the
+         // virtual operations other plugins push outside of any transaction once the block is
+         // applied still belong to it
+         if( !_in_block && ( note.trx_id != transaction_id_type() || note.block != _applied_block_num || _applied_block_num == 0 ) )
+            return;
+
+         add_records( note, _in_block ? _block_records : _late_records );
+      }
+
+      void dapp_history_plugin_impl::add_records( const operation_notification& note, std::vector< dapp_history_record >& records ) {
+         flat_set< dapp_name_type > impacted;
+         operation_get_impacted_dapp( note.op, database(), impacted );
+         if( impacted.empty() )
+            return;
+
+         dapp_history_record record;
+         record.op_type          = operation_get_dapp_type_name( note.op );
+         record.op.trx_id        = note.trx_id;
+         record.op.block         = note.block;
+         record.op.trx_in_block  = note.trx_in_block;
+         record.op.op_in_trx     = note.op_in_trx;
+         record.op.virtual_op    = note.virtual_op;
+         record.op.timestamp     = _block_time;
+         record.op.op            = note.op;
+         get_nsta602_transfer( note.op, record.nsta602_author, record.nsta602_unique_id );
 
          for( const auto& dapp_name : impacted ) {
-            note.op.visit( operation_visitor( db, note, new_obj, dapp_name ) );
+            record.dapp_name = dapp_name;
+            records.push_back( record );
          }
       }
+
+      void dapp_history_plugin_impl::on_applied_block( const signed_block& b ) {
+         _in_block = false;
+         uint32_t block_num = b.block_num();
+         _applied_block_num = block_num;
+
+         // a block we already logged at this height was popped by a fork switch, or the chain is replayed
+         _log.truncate( block_num );
+
+         write_records( _block_records );
+
+         if( _retention_blocks > 0 && block_num > _retention_blocks )
+            _log.prune( block_num - _retention_blocks );
+      }
    } //namespace detail
 
    dapp_history_plugin::dapp_history_plugin( application* app )
       : plugin( app ), _my( new detail::dapp_history_plugin_impl( *this ) ) {}
 
+   void dapp_history_plugin::plugin_set_program_options(
+      boost::program_options::options_description& cli,
+      boost::program_options::options_description& cfg ) {
+      cli.add_options()
+         ("dapp-history-file", boost::program_options::value< string >(),
+            "File holding the dapp operation history. Defaults to dapp_history.log next to the shared memory file")
+         ("dapp-history-retention-blocks", boost::program_options::value< uint32_t >()->default_value( 0 ),
+            "Number of most recent blocks to keep dapp operation history for, 0 keeps all of it")
+         ;
+      cfg.add( cli );
+   }
+
    void dapp_history_plugin::plugin_initialize( const boost::program_options::variables_map& options ) {
       try {
          ilog( "Intializing dapp history plugin" );
 
          chain::database& db = database();
-         add_plugin_index< dapp_history_index >( db );
-         add_plugin_index< nsta602_transfer_history_index >( db );
 
+         fc::path history_file;
+         if( options.count( "dapp-history-file" ) )
+            history_file = fc::path( options.at( "dapp-history-file" ).as< string >() );
+         else
+         {
+            fc::path shared_dir;
+            if( options.count( "shared-file-dir" ) )
+               shared_dir = fc::path( options.at( "shared-file-dir" ).as< string >() );
+            else if( options.count( "data-dir" ) )
+               shared_dir = fc::path( options.at( "data-dir" ).as< boost::filesystem::path >() ) / "blockchain";
+            else
+               shared_dir = fc::path( "blockchain" );
+            history_file = shared_dir / "dapp_history.log";
+         }
+         if( history_file.is_relative() )
+            history_file = fc::current_path() / history_file;
+
+         // a read only node queries the log the writing node keeps up to date
+         _read_only = options.count( "read-only" ) > 0;
+         _my->_log.open( history_file, _read_only );
+         if( _read_only )
+            return;
+
+         if( options.count( "dapp-history-retention-blocks" ) )
+            _my->_retention_blocks = options.at( "dapp-history-retention-blocks" ).as< uint32_t >();
+
+         db.pre_apply_block.connect( [&]( const signed_block& b ){
+            _my->on_pre_apply_block( b );
+         });
          db.pre_apply_operation.connect( [&]( const operation_notification& note ){ 
             _my->on_pre_operation(note); 
          });
+         db.applied_block.connect( [&]( const signed_block& b ){
+            _my->on_applied_block( b );
+         });
 
       } FC_CAPTURE_AND_RETHROW()
    }
 
    void dapp_history_plugin::plugin_startup() {
+      if( !_read_only ) {
+         // blocks are applied under the write lock, so none is recorded while the log catches up
+         database().with_read_lock( [&]() {
+            _my->reconcile();
+         });
+      }
+
       app().register_api_factory< dapp_history_api >( "dapp_history_api" );
    }
 
-} } //namespace sigmaengine::dapp_history
+   void dapp_history_plugin::plugin_shutdown() {
+      if( !_read_only )
+         _my->write_late_records();
+      _my->_log.close();
+   }
 
-SIGMAENGINE_DEFINE_PLUGIN( dapp_history, sigmaengine::dapp_history::dapp_history_plugin )
+   const dapp_history_log& dapp_history_plugin::history_log()const {
+      return _my->_log;
+   }
 
+} } //namespace sigmaengine::dapp_history
 
+SIGMAENGINE_DEFINE_PLUGIN( dapp_history, sigmaengine::dapp_history::dapp_history_plugin )
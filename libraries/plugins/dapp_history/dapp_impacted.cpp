@@ -297,6 +297,77 @@ namespace sigmaengine { namespace dapp_history {
       process_inner_operation< bobserver_plugin_operation >( op.data, get_dapp_name_visitor_from_custom( db, result ) );
    }
 
+   /// operation type name without namespaces and the _operation suffix, e.g. nsta602_transfer
+   template< typename T >
+   string get_operation_short_name() {
+      string name = fc::get_typename< T >::name();
+      name = name.substr( name.find_last_of( ':' ) + 1 );
+      const string suffix = "_operation";
+      if( name.size() > suffix.size() && name.compare( name.size() - suffix.size(), suffix.size(), suffix ) == 0 )
+         name.resize( name.size() - suffix.size() );
+      return name;
+   }
+
+   struct get_inner_type_name_visitor {
+      string& _name;
+      typedef void result_type;
+
+      get_inner_type_name_visitor( string& name ) : _name( name ) {}
+
+      template< typename T >
+      void operator()( const T& op )const {
+         if( _name.empty() )
+            _name = get_operation_short_name< T >();
+      }
+   };
+
+   struct get_type_name_visitor {
+      string& _name;
+      typedef void result_type;
+
+      get_type_name_visitor( string& name ) : _name( name ) {}
+
+      template< typename T >
+      void operator()( const T& op )const {
+         _name = get_operation_short_name< T >();
+      }
+
+      void operator()( const custom_json_operation& op )const {
+         from_inner_json( op.json );
+         if( _name.empty() )
+            _name = get_operation_short_name< custom_json_operation >();
+      }
+
+      void operator()( const custom_json_dapp_operation& op )const {
+         from_inner_json( op.json );
+         if( _name.empty() )
+            _name = get_operation_short_name< custom_json_dapp_operation >();
+      }
+
+      void operator()( const custom_binary_operation& op )const {
+         process_inner_operation< dapp_operation >( op.data, get_inner_type_name_visitor( _name ) );
+         process_inner_operation< token_operation >( op.data, get_inner_type_name_visitor( _name ) );
+         process_inner_operation< bobserver_plugin_operation >( op.data, get_inner_type_name_visitor( _name ) );
+         if( _name.empty() )
+            _name = get_operation_short_name< custom_binary_operation >();
+      }
+
+      void from_inner_json( const string& json )const {
+         try {
+            auto var = fc::json::from_string( json );
+            process_inner_operation< dapp_operation >( var, get_inner_type_name_visitor( _name ) );
+            process_inner_operation< token_operation >( var, get_inner_type_name_visitor( _name ) );
+            process_inner_operation< bobserver_plugin_operation >( var, get_inner_type_name_visitor( _name ) );
+         } catch( const fc::exception& ) { }
+      }
+   };
+
+   string operation_get_dapp_type_name( const operation& op ) {
+      string name;
+      op.visit( get_type_name_visitor( name ) );
+      return name;
+   }
+
    void operation_get_impacted_dapp( const operation& op, chain::database& db, flat_set< dapp_name_type >& result ) {
       get_dapp_name_visitor visitor = get_dapp_name_visitor( db, result );
       op.visit( visitor );
@@ -4,7 +4,7 @@
 #include <sigmaengine/app/sigmaengine_api_objects.hpp>
 #include <sigmaengine/app/applied_operation.hpp>
 
-#include <sigmaengine/dapp_history/dapp_history_objects.hpp>
+#include <sigmaengine/dapp_history/dapp_history_plugin.hpp>
 
 #include <fc/api.hpp>
 
@@ -33,6 +33,19 @@ namespace sigmaengine { namespace dapp_history {
          map< uint32_t, applied_operation > get_dapp_history( string dapp_name, uint64_t from, uint32_t limit )const;
          map< uint32_t, applied_operation > get_dapp_operation_list( uint64_t from, uint32_t limit )const;
 
+         /**
+          *  Same as get_dapp_history but only returns operations of the given types, e.g. "transfer_token" or
+          *  "nsta602_transfer". Returns up to limit matching operations with a sequence of at most from.
+          */
+         map< uint32_t, applied_operation > get_dapp_history_by_type( string dapp_name, vector< string > op_types, uint64_t from, uint32_t limit )const;
+
+         /**
+          *  Returns up to limit operations of the dapp in blocks [start_block, end_block], oldest first.
+          *  @param op_types - operation types to return, empty returns every type
+          */
+         map< uint32_t, applied_operation > get_dapp_history_by_block( string dapp_name, uint32_t start_block, uint32_t end_block,
+            vector< string > op_types, uint32_t limit )const;
+
          map< uint32_t, applied_operation > get_nsta602_transfer_history( string dapp_name, string author, string unique_id, uint64_t from, uint32_t limit )const;
          
       private:
@@ -44,5 +57,7 @@ namespace sigmaengine { namespace dapp_history {
 FC_API( sigmaengine::dapp_history::dapp_history_api,
    ( get_dapp_history )
    ( get_dapp_operation_list )
+   ( get_dapp_history_by_type )
+   ( get_dapp_history_by_block )
    ( get_nsta602_transfer_history )
 )
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <sigmaengine/app/applied_operation.hpp>
+#include <sigmaengine/protocol/types.hpp>
+
+#include <fc/container/flat.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sigmaengine { namespace dapp_history {
+   using sigmaengine::protocol::dapp_name_type;
+   using sigmaengine::protocol::account_name_type;
+
+   /**
+    * One operation as seen by one dapp.  An operation impacting several dapps
+    * is stored once per dapp, each copy with its own sequence numbers.
+    */
+   struct dapp_history_record
+   {
+      dapp_name_type                dapp_name;
+      uint32_t                      sequence = 0;       ///< position in the history of dapp_name
+      uint32_t                      all_sequence = 0;   ///< position in the history of all dapps
+      std::string                   op_type;            ///< operation name, the inner operation for custom operations
+
+      account_name_type             nsta602_author;     ///< only set for nsta602 transfers
+      std::string                   nsta602_unique_id;
+      uint32_t                      nsta602_sequence = 0;
+
+      app::applied_operation        op;
+   };
+
+   namespace detail { class dapp_history_log_impl; }
+
+   /**
+    * Append-only file holding the dapp operation history outside of the
+    * shared memory file, so it no longer grows the consensus state or the
+    * undo history.
+    *
+    * Records are packed one after the other in block order.  The log keeps an
+    * index per dapp in memory as parallel columns of block number, operation
+    * type and file offset, so range and type filtered queries only read the
+    * records they return.  The index is rebuilt from the file on open.
+    *
+    * Records of a block are written once the block is applied.  A block that
+    * is applied again after a fork switch or a replay truncates the log back
+    * to it first.  Records older than the retention window are dropped from
+    * the index, and the file is compacted once most of it is dead.  A dapp
+    * that had no operation inside the window restarts its sequence numbers
+    * after a compaction.
+    *
+    * A state file next to the log holds the last block whose records are all
+    * written, so the log can be reconciled with the chain after a crash, and
+    * a counter of truncations.  A read only node opens the log without
+    * changing either file and catches its index up with the writer before
+    * every query.
+    */
+   class dapp_history_log
+   {
+      public:
+         dapp_history_log();
+         ~dapp_history_log();
+
+         void open( const fc::path& file, bool read_only = false );
+         void close();
+         bool is_open()const;
+
+         /** Number of the last block with records in the log, 0 when the log is empty */
+         uint32_t last_block()const;
+
+         /** Number of the last block whose records, including the ones pushed after it was applied, are all in the log */
+         uint32_t head_block()const;
+         void set_head_block( uint32_t block_num );
+
+         /** Drops the records of block_num and of every later block */
+         void truncate( uint32_t block_num );
+
+         /** Assigns the sequence numbers of the records of one block and appends them */
+         void append( std::vector< dapp_history_record >& records );
+
+         /** Forgets the records of blocks before block_num */
+         void prune( uint32_t block_num );
+
+         /**
+          * Records of dapp_name with a sequence in [from - limit, from], most recent first.
+          * When op_types is not empty only matching records are returned, up to limit of them.
+          */
+         std::vector< dapp_history_record > get_dapp_history( const dapp_name_type& dapp_name, uint64_t from, uint32_t limit,
+            const fc::flat_set< std::string >& op_types = fc::flat_set< std::string >() )const;
+
+         /** Records of dapp_name in blocks [start_block, end_block] matching op_types, oldest first */
+         std::vector< dapp_history_record > get_dapp_history_by_block( const dapp_name_type& dapp_name, uint32_t start_block, uint32_t end_block,
+            const fc::flat_set< std::string >& op_types, uint32_t limit )const;
+
+         /** Records of all dapps with an all_sequence in [from - limit, from], most recent first */
+         std::vector< dapp_history_record > get_operation_list( uint64_t from, uint32_t limit )const;
+
+         /** nsta602 transfers of one item with a sequence in [from - limit, from], most recent first */
+         std::vector< dapp_history_record > get_nsta602_transfer_history( const dapp_name_type& dapp_name, const account_name_type& author,
+            const std::string& unique_id, uint64_t from, uint32_t limit )const;
+
+      private:
+         std::unique_ptr< detail::dapp_history_log_impl > my;
+   };
+
+} } // sigmaengine::dapp_history
+
+FC_REFLECT( sigmaengine::dapp_history::dapp_history_record,
+   (dapp_name)(sequence)(all_sequence)(op_type)(nsta602_author)(nsta602_unique_id)(nsta602_sequence)(op) )
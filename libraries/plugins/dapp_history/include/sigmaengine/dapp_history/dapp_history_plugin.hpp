@@ -3,6 +3,8 @@
 #include <sigmaengine/app/plugin.hpp>
 #include <sigmaengine/chain/database.hpp>
 
+#include <sigmaengine/dapp_history/dapp_history_log.hpp>
+
 #include <fc/thread/future.hpp>
 
 #define DAPP_HISTORY_PLUGIN_NAME "dapp_history"
@@ -20,13 +22,20 @@ namespace sigmaengine { namespace dapp_history {
          dapp_history_plugin( application* app );
 
          std::string plugin_name()const override { return DAPP_HISTORY_PLUGIN_NAME; }
+         virtual void plugin_set_program_options(
+            boost::program_options::options_description& cli,
+            boost::program_options::options_description& cfg ) override;
          virtual void plugin_initialize(const boost::program_options::variables_map& options) override;
          virtual void plugin_startup() override;
+         virtual void plugin_shutdown() override;
+
+         const dapp_history_log& history_log()const;
 
          friend class detail::dapp_history_plugin_impl;
          
       private:
          std::unique_ptr<detail::dapp_history_plugin_impl> _my;
+         bool _read_only = false;
    };
 
 } } //namespace sigmaengine::dapp_history
\ No newline at end of file
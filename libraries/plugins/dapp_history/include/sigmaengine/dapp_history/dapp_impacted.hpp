@@ -57,4 +57,7 @@ namespace sigmaengine { namespace dapp_history {
       chain::database& db,
       fc::flat_set< protocol::dapp_name_type >& result );
 
+   /** Name of the operation, or of the first dapp, token or bobserver operation wrapped by a custom operation */
+   string operation_get_dapp_type_name( const sigmaengine::protocol::operation& op );
+
 } } // sigmaengine::dapp_history
@@ -16,13 +16,15 @@ namespace sigmaengine { namespace token {
             publisher( o.publisher ),
             dapp_name( o.dapp_name ),
             init_supply( o.init_supply ),
-            total_balance( o.total_balance ) {}
+            total_balance( o.total_balance ),
+            holder_count( o.holder_count ) {}
 
       string            name;
       account_name_type publisher;
       dapp_name_type    dapp_name;
       asset             init_supply;
       asset             total_balance;
+      uint32_t          holder_count = 0;
    };
 
    struct token_balance_api_object {
@@ -170,6 +172,22 @@ namespace sigmaengine { namespace token {
           * */
          vector< token_balance_api_object > get_accounts_by_token( string token_name ) const;
 
+         /**
+          * get holders of a token ranked by balance, largest first
+          * @param token_name token name
+          * @param from rank of the first holder to return, 0 for the largest holder
+          * @param limit max count to read from db. limit is 1000 or less.
+          * @return balances of the holders
+          * */
+         vector< token_balance_api_object > get_token_holders( string token_name, uint32_t from, uint32_t limit ) const;
+
+         /**
+          * get the number of accounts holding a token
+          * @param token_name token name
+          * @return number of accounts with a balance or savings balance of the token
+          * */
+         uint32_t get_token_holder_count( string token_name ) const;
+
          /**
           * get token list by dapp name
           * @param dapp_name dapp name
@@ -250,6 +268,7 @@ FC_REFLECT( sigmaengine::token::token_api_object,
    ( dapp_name )
    ( init_supply )
    ( total_balance )
+   ( holder_count )
 );
 
 FC_REFLECT( sigmaengine::token::token_balance_api_object, 
@@ -308,6 +327,8 @@ FC_API( sigmaengine::token::token_api,
    ( get_token )
    ( lookup_tokens )
    ( get_accounts_by_token )
+   ( get_token_holders )
+   ( get_token_holder_count )
    ( get_tokens_by_dapp )
    ( get_token_staking_list )
    ( lookup_token_fund_withdraw )
@@ -7,6 +7,7 @@
 #include <sigmaengine/dapp/dapp_objects.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/ranked_index.hpp>
 
 
 namespace sigmaengine { namespace token {
@@ -41,6 +42,7 @@ namespace sigmaengine { namespace token {
          dapp_name_type    dapp_name;
          asset             init_supply;
          asset             total_balance;
+         uint32_t          holder_count = 0;   ///< number of token_balance_objects of this token
          time_point_sec    created;
          time_point_sec    last_updated;
    };
@@ -58,6 +60,7 @@ namespace sigmaengine { namespace token {
 
          id_type           id;
          account_name_type account;
+         token_id_type     token_id;   ///< interned token, the lookup key together with account
          token_name_type   token;
          asset             balance;
          asset             savings_balance;
@@ -75,6 +78,7 @@ namespace sigmaengine { namespace token {
          }
 
          id_type           id;
+         token_id_type     token_id;
          token_name_type   token;
          fund_name_type    fund_name;
          asset             balance;
@@ -147,6 +151,7 @@ namespace sigmaengine { namespace token {
          uint32_t          request_id = 0;
          asset             amount;
          asset             total_amount;
+         asset             split_pay_amount;   ///< paid every cycle but the last, which pays the remaining amount
          shared_string     memo;
          uint8_t           split_pay_order = 0;
          uint8_t           split_pay_month = 0;
@@ -160,6 +165,7 @@ namespace sigmaengine { namespace token {
    struct by_symbol;
    struct by_account_and_token;
    struct by_token;
+   struct by_token_balance;
    struct by_dapp_name;
    
    typedef multi_index_container <
@@ -198,12 +204,22 @@ namespace sigmaengine { namespace token {
             composite_key < 
                token_balance_object,
                member < token_balance_object, account_name_type, & token_balance_object::account >,
-               member < token_balance_object, token_name_type, & token_balance_object::token >
+               member < token_balance_object, token_id_type, & token_balance_object::token_id >
             >
          >,
          ordered_non_unique <
             tag< by_token >,
-            member < token_balance_object, token_name_type, & token_balance_object::token >
+            member < token_balance_object, token_id_type, & token_balance_object::token_id >
+         >,
+         ranked_unique <
+            tag< by_token_balance >,
+            composite_key <
+               token_balance_object,
+               member < token_balance_object, token_id_type, & token_balance_object::token_id >,
+               member < token_balance_object, asset, & token_balance_object::balance >,
+               member < token_balance_object, account_name_type, & token_balance_object::account >
+            >,
+            composite_key_compare < std::less< token_id_type >, std::greater< asset >, std::less< account_name_type > >
          >
       >,
       allocator < token_balance_object >
@@ -223,7 +239,7 @@ namespace sigmaengine { namespace token {
             tag< by_token_and_fund >,
             composite_key < 
                token_fund_object,
-               member < token_fund_object, token_name_type, & token_fund_object::token >,
+               member < token_fund_object, token_id_type, & token_fund_object::token_id >,
                member < token_fund_object, fund_name_type, & token_fund_object::fund_name >
             >
          >,
@@ -232,7 +248,7 @@ namespace sigmaengine { namespace token {
             composite_key < 
                token_fund_object,
                member < token_fund_object, fund_name_type, & token_fund_object::fund_name >,
-               member < token_fund_object, token_name_type, & token_fund_object::token >
+               member < token_fund_object, token_id_type, & token_fund_object::token_id >
             >
          >
       >,
@@ -281,9 +297,12 @@ namespace sigmaengine { namespace token {
                member < token_fund_withdraw_object, uint32_t, &token_fund_withdraw_object::request_id >
             >
          >,
-         ordered_non_unique< 
+         ordered_unique< 
             tag< by_complete >,
-            member < token_fund_withdraw_object, time_point_sec,  &token_fund_withdraw_object::complete >
+            composite_key< token_fund_withdraw_object,
+               member < token_fund_withdraw_object, time_point_sec,  &token_fund_withdraw_object::complete >,
+               member < token_fund_withdraw_object, token_fund_withdraw_id_type, &token_fund_withdraw_object::id >
+            >
          >,
          ordered_unique< 
             tag< by_from_fund >,
@@ -352,6 +371,7 @@ FC_REFLECT( sigmaengine::token::token_object,
             ( dapp_name )
             ( init_supply )
             ( total_balance) 
+            ( holder_count )
             ( created )
             ( last_updated )
 )
@@ -360,6 +380,7 @@ CHAINBASE_SET_INDEX_TYPE( sigmaengine::token::token_object, sigmaengine::token::
 FC_REFLECT( sigmaengine::token::token_balance_object, 
             ( id )
             ( account )
+            ( token_id )
             ( token )
             ( balance )
             ( savings_balance )
@@ -369,6 +390,7 @@ CHAINBASE_SET_INDEX_TYPE( sigmaengine::token::token_balance_object, sigmaengine:
 
 FC_REFLECT( sigmaengine::token::token_fund_object, 
             ( id )
+            ( token_id )
             ( token )
             ( fund_name )
             ( balance )
@@ -409,6 +431,7 @@ FC_REFLECT( sigmaengine::token::token_savings_withdraw_object,
             ( request_id ) 
             ( amount )
             ( total_amount )
+            ( split_pay_amount )
             ( memo )
             ( split_pay_order )
             ( split_pay_month )
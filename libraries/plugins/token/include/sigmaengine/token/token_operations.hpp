@@ -45,6 +45,27 @@ namespace sigmaengine { namespace token {
        void get_required_active_authorities( flat_set< account_name_type >& a )const { a.insert( from ); }
    };
 
+   struct token_transfer_target
+   {
+      account_name_type  to;
+      asset              amount;
+   };
+
+   /**
+    * Transfers one token from a single account to many recipients (airdrops, payroll).
+    * The sender is debited once for the total and pays the dapp fee for every recipient.
+    * Enabled by hardfork 0.2.
+    */
+   struct multi_transfer_token_operation : base_operation
+   {
+      account_name_type                from;
+      vector< token_transfer_target >  transfers;
+      string                           memo;
+
+      void validate()const;
+      void get_required_active_authorities( flat_set< account_name_type >& a )const { a.insert( from ); }
+   };
+
    struct burn_token_operation : base_operation
    {
        account_name_type account;
@@ -147,6 +168,7 @@ namespace sigmaengine { namespace token {
       , transfer_token_savings_operation
       , cancel_transfer_token_savings_operation
       , conclude_transfer_token_savings_operation
+      , multi_transfer_token_operation
    > token_operation;
 
    DEFINE_PLUGIN_EVALUATOR(token_plugin, token_operation, create_token)
@@ -160,6 +182,7 @@ namespace sigmaengine { namespace token {
    DEFINE_PLUGIN_EVALUATOR(token_plugin, token_operation, transfer_token_savings)
    DEFINE_PLUGIN_EVALUATOR(token_plugin, token_operation, cancel_transfer_token_savings)
    DEFINE_PLUGIN_EVALUATOR(token_plugin, token_operation, conclude_transfer_token_savings)
+   DEFINE_PLUGIN_EVALUATOR(token_plugin, token_operation, multi_transfer_token)
 } } //namespace sigmaengine::token
 
 FC_REFLECT( sigmaengine::token::create_token_operation,
@@ -182,6 +205,15 @@ FC_REFLECT( sigmaengine::token::transfer_token_operation,
    ( amount )
    ( memo ) )
 
+FC_REFLECT( sigmaengine::token::token_transfer_target,
+   ( to )
+   ( amount ) )
+
+FC_REFLECT( sigmaengine::token::multi_transfer_token_operation,
+   ( from )
+   ( transfers )
+   ( memo ) )
+
 FC_REFLECT(sigmaengine::token::burn_token_operation,
    ( account )
    ( amount ) )
@@ -5,14 +5,21 @@ namespace sigmaengine { namespace token { namespace util {
       public:
       token_util( database& db ) : _db( db ){}
 
-      void adjust_token_fund_balance( const token_name_type& token, const fund_name_type fund, const asset& delta, const asset& withdraw_delta ) {
+      const token_object& get_token( const token_name_type& name ) {
+         const auto& token_idx = _db.get_index< token_index >().indices().get< by_name >();
+         auto token_itr = token_idx.find( name );
+         FC_ASSERT( token_itr != token_idx.end(), "There isn't ${token} token.", ( "token", name ) );
+         return *token_itr;
+      }
+
+      void adjust_token_fund_balance( const token_object& token, const fund_name_type fund, const asset& delta, const asset& withdraw_delta ) {
          try {
             const auto& fund_idx = _db.get_index< token_fund_index >().indices().get< by_token_and_fund >();
-            auto fund_itr  = fund_idx.find( std::make_tuple( token, fund ) );
+            auto fund_itr  = fund_idx.find( std::make_tuple( token.id, fund ) );
 
             auto now = _db.head_block_time();
 
-            FC_ASSERT( fund_itr != fund_idx.end(), "There isn't ${token}/${fund} fund.", ("token", token)("fund", fund) );
+            FC_ASSERT( fund_itr != fund_idx.end(), "There isn't ${token}/${fund} fund.", ("token", token.name)("fund", fund) );
             FC_ASSERT( fund_itr->balance.symbol == delta.symbol, "Invalid symbol" );
 
             FC_ASSERT( delta.amount >= 0 || fund_itr->balance >= -delta, "Balances lack." );
@@ -23,25 +30,25 @@ namespace sigmaengine { namespace token { namespace util {
                obj.withdraw_balance += withdraw_delta;
                obj.last_updated = now;
             });
-         } FC_CAPTURE_AND_RETHROW( ( token )( fund )( delta )( withdraw_delta ) )
+         } FC_CAPTURE_AND_RETHROW( ( token.name )( fund )( delta )( withdraw_delta ) )
       }
 
-      void adjust_token_balance( const account_name_type& account, const token_name_type& token, const asset& delta ) {
+      void adjust_token_balance( const account_name_type& account, const token_object& token, const asset& delta ) {
          try {
             auto now = _db.head_block_time();
             const auto& balance_idx = _db.get_index< token_balance_index >().indices().get< by_account_and_token >();
-            auto balance_itr = balance_idx.find( boost::make_tuple( account, token ) );
+            auto balance_itr = balance_idx.find( boost::make_tuple( account, token.id ) );
 
             FC_ASSERT( _db.find_account( account ) != nullptr, "No accounts" );
             
             if( delta.amount < 0 ) {
                FC_ASSERT(balance_itr != balance_idx.end(), "${account} account doesn't have ${token} token balance."
-                  , ( "token", token )( "account", account ) );
+                  , ( "token", token.name )( "account", account ) );
 
                FC_ASSERT( balance_itr->balance.symbol == delta.symbol, "invalid symbol" );
 
                if( balance_itr->savings_balance.amount == 0 && balance_itr->balance == -delta ){
-                  _db.remove( *balance_itr );
+                  remove_token_balance( *balance_itr, token );
                } else {
                   FC_ASSERT( balance_itr->balance >= -delta, "Balances lack" );
 
@@ -52,13 +59,7 @@ namespace sigmaengine { namespace token { namespace util {
                }
             } else {
                if(balance_itr == balance_idx.end()) {
-                  _db.create< token_balance_object >( [&]( token_balance_object& obj ) {
-                     obj.account = account;
-                     obj.token = token;
-                     obj.balance = delta;
-                     obj.savings_balance = asset(0, delta.symbol);
-                     obj.last_updated = now;
-                  });
+                  create_token_balance( account, token, delta, asset( 0, delta.symbol ) );
                } else {
                   FC_ASSERT( balance_itr->balance.symbol == delta.symbol, "invalid symbol" );
                   
@@ -68,25 +69,25 @@ namespace sigmaengine { namespace token { namespace util {
                   });
                }
             }
-         } FC_CAPTURE_AND_RETHROW( ( account )( token )( delta ) )
+         } FC_CAPTURE_AND_RETHROW( ( account )( token.name )( delta ) )
       }
 
-      void adjust_token_savings_balance( const account_name_type& account, const token_name_type& token, const asset& delta ) {
+      void adjust_token_savings_balance( const account_name_type& account, const token_object& token, const asset& delta ) {
          try {
             auto now = _db.head_block_time();
             const auto& balance_idx = _db.get_index< token_balance_index >().indices().get< by_account_and_token >();
-            auto balance_itr = balance_idx.find( boost::make_tuple( account, token ) );
+            auto balance_itr = balance_idx.find( boost::make_tuple( account, token.id ) );
 
             FC_ASSERT( _db.find_account( account ) != nullptr, "No accounts" );
             
             if( delta.amount < 0 ) {
                FC_ASSERT(balance_itr != balance_idx.end(), "${account} account doesn't have ${token} token savings balance."
-                  , ( "token", token )( "account", account ) );
+                  , ( "token", token.name )( "account", account ) );
 
                FC_ASSERT( balance_itr->savings_balance.symbol == delta.symbol, "invalid symbol" );
 
                if( balance_itr->balance.amount == 0 && balance_itr->savings_balance == -delta ){
-                  _db.remove( *balance_itr );
+                  remove_token_balance( *balance_itr, token );
                } else {
                   FC_ASSERT( balance_itr->savings_balance >= -delta, "Savings balances lack" );
 
@@ -97,13 +98,7 @@ namespace sigmaengine { namespace token { namespace util {
                }
             } else {
                if(balance_itr == balance_idx.end()) {
-                  _db.create< token_balance_object >( [&]( token_balance_object& obj ) {
-                     obj.account = account;
-                     obj.token = token;
-                     obj.balance = asset(0, delta.symbol);
-                     obj.savings_balance = delta;
-                     obj.last_updated = now;
-                  });
+                  create_token_balance( account, token, asset( 0, delta.symbol ), delta );
                } else {
                   FC_ASSERT( balance_itr->savings_balance.symbol == delta.symbol, "invalid symbol" );
                   
@@ -113,7 +108,33 @@ namespace sigmaengine { namespace token { namespace util {
                   });
                }
             }
-         } FC_CAPTURE_AND_RETHROW( ( account )( token )( delta ) )
+         } FC_CAPTURE_AND_RETHROW( ( account )( token.name )( delta ) )
+      }
+
+      /// every balance object of a token is a holder, token_object::holder_count follows their creation and removal
+      const token_balance_object& create_token_balance( const account_name_type& account, const token_object& token, const asset& balance, const asset& savings_balance ) {
+         auto now = _db.head_block_time();
+         const auto& new_balance = _db.create< token_balance_object >( [&]( token_balance_object& obj ) {
+            obj.account = account;
+            obj.token_id = token.id;
+            obj.token = token.name;
+            obj.balance = balance;
+            obj.savings_balance = savings_balance;
+            obj.last_updated = now;
+         });
+
+         _db.modify( token, [&]( token_object& obj ) {
+            obj.holder_count++;
+         });
+         return new_balance;
+      }
+
+      void remove_token_balance( const token_balance_object& balance, const token_object& token ) {
+         _db.remove( balance );
+
+         _db.modify( token, [&]( token_object& obj ) {
+            obj.holder_count--;
+         });
       }
 
    private:
@@ -14,6 +14,8 @@ namespace sigmaengine { namespace token {
             optional< token_api_object > get_token( string& name ) const;
             vector< token_api_object > lookup_tokens(const string& lower_bound_name, uint32_t limit) const;
             vector< token_balance_api_object > get_accounts_by_token( string& token_name ) const;
+            vector< token_balance_api_object > get_token_holders( string& token_name, uint32_t from, uint32_t limit ) const;
+            uint32_t get_token_holder_count( string& token_name ) const;
             vector< token_api_object > get_tokens_by_dapp( string& dapp_name ) const;
             vector< token_fund_withdraw_api_obj > get_token_staking_list( string account, string token ) const;
             vector< token_fund_withdraw_api_obj > lookup_token_fund_withdraw ( string token, string fund, string account, int req_id, uint32_t limit ) const;
@@ -67,16 +69,50 @@ namespace sigmaengine { namespace token {
 
       vector< token_balance_api_object > token_api_impl::get_accounts_by_token( string& token_name ) const {
          vector <token_balance_api_object > results;
+         const auto& token_idx = _app.chain_database()->get_index< token_index >().indices().get< by_name >();
+         auto token_itr = token_idx.find( token_name );
+         if( token_itr == token_idx.end() )
+            return results;
+
          const auto& balance_index = _app.chain_database()->get_index< token_balance_index >().indices().get < by_token >();
-         auto itr = balance_index.find( token_name );
+         auto itr = balance_index.find( token_itr->id );
+
+         while( itr != balance_index.end() && itr->token_id == token_itr->id ) {
+            results.push_back( *itr );
+            itr++;
+         }
+         return results;
+      }
 
-         while( itr != balance_index.end() && itr->token == token_name ) {
+      vector< token_balance_api_object > token_api_impl::get_token_holders( string& token_name, uint32_t from, uint32_t limit ) const {
+         FC_ASSERT( limit <= 1000 );
+         vector< token_balance_api_object > results;
+         const auto& token_idx = _app.chain_database()->get_index< token_index >().indices().get< by_name >();
+         auto token_itr = token_idx.find( token_name );
+         if( token_itr == token_idx.end() )
+            return results;
+
+         // holders of a token are contiguous in the ranked index, so the page starts at the rank of the first one plus from
+         const auto& balance_index = _app.chain_database()->get_index< token_balance_index >().indices().get< by_token_balance >();
+         auto first = balance_index.rank( balance_index.lower_bound( token_itr->id ) );
+         if( from >= token_itr->holder_count )
+            return results;
+
+         results.reserve( std::min( limit, token_itr->holder_count - from ) );
+         auto itr = balance_index.nth( first + from );
+         while( itr != balance_index.end() && itr->token_id == token_itr->id && results.size() < limit ) {
             results.push_back( *itr );
             itr++;
          }
          return results;
       }
 
+      uint32_t token_api_impl::get_token_holder_count( string& token_name ) const {
+         const auto& token_idx = _app.chain_database()->get_index< token_index >().indices().get< by_name >();
+         auto token_itr = token_idx.find( token_name );
+         return token_itr != token_idx.end() ? token_itr->holder_count : 0;
+      }
+
       vector< token_api_object > token_api_impl::get_tokens_by_dapp( string& dapp_name ) const {
          vector< token_api_object > results;
          const auto& token_idx = _app.chain_database()->get_index< token_index >().indices().get< by_dapp_name >();
@@ -116,8 +152,13 @@ namespace sigmaengine { namespace token {
       }
 
       optional< token_fund_api_obj > token_api_impl::get_token_fund( string token, string fund ) const {
+         const auto& token_idx = _app.chain_database()->get_index< token_index >().indices().get< by_name >();
+         auto token_itr = token_idx.find( token );
+         if( token_itr == token_idx.end() )
+            return {};
+
          const auto& fund_idx = _app.chain_database()->get_index< token_fund_index >().indices().get< by_token_and_fund >();
-         auto itr = fund_idx.find( boost::make_tuple( token, fund ) );
+         auto itr = fund_idx.find( boost::make_tuple( token_itr->id, fund ) );
 
          if( itr != fund_idx.end() )
             return token_fund_api_obj( *itr );
@@ -207,6 +248,18 @@ namespace sigmaengine { namespace token {
       });
    }
 
+   vector< token_balance_api_object > token_api::get_token_holders( string token_name, uint32_t from, uint32_t limit ) const {
+      return _my->database().with_read_lock( [ & ]() {
+         return _my->get_token_holders( token_name, from, limit );
+      });
+   }
+
+   uint32_t token_api::get_token_holder_count( string token_name ) const {
+      return _my->database().with_read_lock( [ & ]() {
+         return _my->get_token_holder_count( token_name );
+      });
+   }
+
    vector< token_api_object > token_api::get_tokens_by_dapp( string dapp_name ) const {
       return _my->database().with_read_lock( [ & ]() {
          return _my->get_tokens_by_dapp( dapp_name );
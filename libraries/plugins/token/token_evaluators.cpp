@@ -8,6 +8,8 @@
 #include <boost/tuple/tuple.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+
 namespace sigmaengine { namespace token {
 
    void create_token_evaluator::do_apply( const create_token_operation& op )
@@ -68,7 +70,7 @@ namespace sigmaengine { namespace token {
 
          auto now = _db.head_block_time();
 
-         _db.create< token_object > ( [&]( token_object& token )
+         const auto& new_token = _db.create< token_object > ( [&]( token_object& token )
          {
             token.name = op.name;
             token.symbol = symbol;
@@ -80,17 +82,10 @@ namespace sigmaengine { namespace token {
             token.last_updated = now;
          });
 
-         const auto& balance_itr = _db.find< token_balance_object, by_account_and_token >( boost::make_tuple( op.publisher, op.name ) );
+         const auto& balance_itr = _db.find< token_balance_object, by_account_and_token >( boost::make_tuple( op.publisher, new_token.id ) );
          if(balance_itr == nullptr) 
          {
-            _db.create< token_balance_object > ( [&]( token_balance_object& token_balance )
-            {
-               token_balance.account = op.publisher;
-               token_balance.token = op.name;
-               token_balance.balance = init_supply;
-               token_balance.savings_balance = asset(0, symbol);
-               token_balance.last_updated = now;
-            });
+            util::token_util( _db ).create_token_balance( op.publisher, new_token, init_supply, asset( 0, symbol ) );
          } 
          else 
          {
@@ -152,17 +147,10 @@ namespace sigmaengine { namespace token {
             obj.last_updated = now;
          });
 
-         const auto& balance_itr = _db.find< token_balance_object, by_account_and_token >( boost::make_tuple( op.publisher, op.name ) );
+         const auto& balance_itr = _db.find< token_balance_object, by_account_and_token >( boost::make_tuple( op.publisher, token_itr->id ) );
          if(balance_itr == nullptr) 
          {
-            _db.create< token_balance_object > ( [&]( token_balance_object& token_balance )
-            {
-               token_balance.account = op.publisher;
-               token_balance.token = op.name;
-               token_balance.balance = op.reissue_amount;
-               token_balance.savings_balance = asset(0, op.reissue_amount.symbol);
-               token_balance.last_updated = now;
-            });
+            util::token_util( _db ).create_token_balance( op.publisher, *token_itr, op.reissue_amount, asset( 0, op.reissue_amount.symbol ) );
          } 
          else 
          {
@@ -203,8 +191,57 @@ namespace sigmaengine { namespace token {
          FC_ASSERT( from_account.balance >= dapp_transaction_fee, "Balance of ${account} account is less than dapp transaction fee"
                , ( "account", from_account ) );
          util::token_util utils(_db);
-         utils.adjust_token_balance( op.from, token_itr->name, -op.amount);
-         utils.adjust_token_balance( op.to, token_itr->name, op.amount );
+         utils.adjust_token_balance( op.from, *token_itr, -op.amount);
+         utils.adjust_token_balance( op.to, *token_itr, op.amount );
+
+         // process transferring fee
+         if ( dapp_transaction_fee.amount > 0 )
+         {
+            _db.adjust_balance( from_account, -dapp_transaction_fee );
+            _db.adjust_dapp_reward_fund_balance( dapp_transaction_fee );
+            _db.push_virtual_operation( dapp_fee_virtual_operation( from_account.name, token_itr->dapp_name, dapp_transaction_fee ) );
+         }
+      } FC_CAPTURE_AND_RETHROW( ( op ) )
+   }
+
+   void multi_transfer_token_evaluator::do_apply( const multi_transfer_token_operation& op )
+   {
+      try {
+         database& _db = db();
+         FC_ASSERT( _db.has_hardfork( SIGMAENGINE_HARDFORK_0_2 ), "multi_transfer_token_operation is not enabled until hardfork 0.2" );
+
+         const auto& symbol = op.transfers.front().amount.symbol;
+         const auto& token_idx = _db.get_index< token_index >().indices().get< by_symbol >();
+         auto token_itr = token_idx.find( symbol );
+         FC_ASSERT( token_itr != token_idx.end(), "There isn't token information about ${symbol}."
+            , ( "symbol", op.transfers.front().amount.symbol_name() ) );
+
+         // process dapp transaction fee, charged for every target as if each were its own transfer
+         const asset& fee_per_transfer = _db.get_dynamic_global_properties().dapp_transaction_fee;
+         const asset dapp_transaction_fee( fee_per_transfer.amount * int64_t( op.transfers.size() ), fee_per_transfer.symbol );
+         const auto& from_account = _db.get_account( op.from );
+         FC_ASSERT( from_account.balance >= dapp_transaction_fee, "Balance of ${account} account is less than dapp transaction fee"
+               , ( "account", from_account ) );
+
+         asset total( 0, symbol );
+         vector< const token_transfer_target* > targets;
+         targets.reserve( op.transfers.size() );
+         for( const auto& t : op.transfers )
+         {
+            total += t.amount;
+            targets.push_back( &t );
+         }
+
+         util::token_util utils(_db);
+         utils.adjust_token_balance( op.from, *token_itr, -total );
+
+         // credit in key order so consecutive lookups walk neighbouring nodes of the balance index
+         std::sort( targets.begin(), targets.end(), []( const token_transfer_target* a, const token_transfer_target* b )
+         {
+            return a->to < b->to;
+         });
+         for( const auto* t : targets )
+            utils.adjust_token_balance( t->to, *token_itr, t->amount );
 
          // process transferring fee
          if ( dapp_transaction_fee.amount > 0 )
@@ -238,7 +275,7 @@ namespace sigmaengine { namespace token {
                , ( "account", dapp_itr->owner) );
 
          util::token_util utils(_db);
-         utils.adjust_token_balance( op.account, token_itr->name, -op.amount );
+         utils.adjust_token_balance( op.account, *token_itr, -op.amount );
 
          _db.modify( *token_itr, [&]( token_object& token_obj )
          {
@@ -270,7 +307,7 @@ namespace sigmaengine { namespace token {
          FC_ASSERT( token_itr->symbol == op.init_fund_balance.symbol );
 
          const auto& fund_idx = _db.get_index< token_fund_index >().indices().get< by_token_and_fund >();
-         auto fund_itr  = fund_idx.find( boost::make_tuple( op.token, op.fund_name ) );
+         auto fund_itr  = fund_idx.find( boost::make_tuple( token_itr->id, op.fund_name ) );
 
          // process dapp transaction fee
          const asset dapp_transaction_fee = _db.get_dynamic_global_properties().dapp_transaction_fee;
@@ -280,11 +317,12 @@ namespace sigmaengine { namespace token {
 
          if( op.init_fund_balance.amount > 0 ) {
             util::token_util utils(_db);
-            utils.adjust_token_balance( op.token_publisher, token_itr->name, -op.init_fund_balance );
+            utils.adjust_token_balance( op.token_publisher, *token_itr, -op.init_fund_balance );
          }
 
          if( fund_itr ==  fund_idx.end() ) {
             _db.create< token_fund_object >( [&]( token_fund_object& fund_obj ) {
+               fund_obj.token_id = token_itr->id;
                fund_obj.token = op.token;
                fund_obj.fund_name = op.fund_name;
                fund_obj.balance = op.init_fund_balance;
@@ -401,8 +439,8 @@ namespace sigmaengine { namespace token {
                , ( "account", token_itr->publisher ) );
 
          util::token_util utils(_db);
-         utils.adjust_token_balance( op.from, op.token, -op.amount );
-         utils.adjust_token_fund_balance( op.token, op.fund_name, op.amount, asset(0, op.amount.symbol) );
+         utils.adjust_token_balance( op.from, *token_itr, -op.amount );
+         utils.adjust_token_fund_balance( *token_itr, op.fund_name, op.amount, asset(0, op.amount.symbol) );
 
          // process transferring fee
          if ( dapp_transaction_fee.amount > 0 )
@@ -443,8 +481,8 @@ namespace sigmaengine { namespace token {
          auto amount = op.amount + asset( temp_amount , token_itr->symbol);
 
          util::token_util utils(_db);
-         utils.adjust_token_balance( op.from, token_itr->name, -op.amount );
-         utils.adjust_token_fund_balance( op.token, op.fund_name, op.amount, amount );
+         utils.adjust_token_balance( op.from, *token_itr, -op.amount );
+         utils.adjust_token_fund_balance( *token_itr, op.fund_name, op.amount, amount );
 
          auto now = _db.head_block_time();
 
@@ -492,8 +530,8 @@ namespace sigmaengine { namespace token {
          FC_ASSERT( op.next_date > _db.head_block_time()  );
 
          util::token_util utils(_db);
-         utils.adjust_token_balance( op.from, token_itr->name, -op.amount );
-         utils.adjust_token_savings_balance( op.to, token_itr->name, op.amount );
+         utils.adjust_token_balance( op.from, *token_itr, -op.amount );
+         utils.adjust_token_savings_balance( op.to, *token_itr, op.amount );
 
          auto now = _db.head_block_time();
          _db.create< token_savings_withdraw_object >( [&]( token_savings_withdraw_object& obj ) {
@@ -502,6 +540,8 @@ namespace sigmaengine { namespace token {
             obj.token = op.token;
             obj.amount = op.amount;
             obj.total_amount = op.amount;
+            obj.split_pay_amount = op.amount;
+            obj.split_pay_amount.amount /= op.split_pay_month;
             obj.split_pay_order = 1;
             obj.split_pay_month = op.split_pay_month;
 #ifndef IS_LOW_MEM
@@ -547,8 +587,8 @@ namespace sigmaengine { namespace token {
          FC_ASSERT( withdraw_itr != withdraw_idx.end(), "No withdraw information");
 
          util::token_util utils(_db);
-         utils.adjust_token_savings_balance( withdraw_itr->to, op.token, -( withdraw_itr->amount ) );
-         utils.adjust_token_balance( op.from, op.token, withdraw_itr->amount );
+         utils.adjust_token_savings_balance( withdraw_itr->to, *token_itr, -( withdraw_itr->amount ) );
+         utils.adjust_token_balance( op.from, *token_itr, withdraw_itr->amount );
 
          _db.remove( *withdraw_itr );
 
@@ -585,8 +625,8 @@ namespace sigmaengine { namespace token {
          FC_ASSERT( withdraw_itr != withdraw_idx.end(), "No withdraw information");
 
          util::token_util utils(_db);
-         utils.adjust_token_savings_balance( withdraw_itr->to, op.token, -( withdraw_itr->amount ) );
-         utils.adjust_token_balance( withdraw_itr->to, op.token, withdraw_itr->amount );
+         utils.adjust_token_savings_balance( withdraw_itr->to, *token_itr, -( withdraw_itr->amount ) );
+         utils.adjust_token_balance( withdraw_itr->to, *token_itr, withdraw_itr->amount );
 
          _db.push_virtual_operation( fill_transfer_token_savings_operation( withdraw_itr->from, withdraw_itr->to
                   , withdraw_itr->token, withdraw_itr->request_id, withdraw_itr->amount, withdraw_itr->total_amount
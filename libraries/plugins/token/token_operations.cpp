@@ -52,6 +52,29 @@ namespace sigmaengine { namespace token {
       } FC_CAPTURE_AND_RETHROW( ( *this ) )
    }
 
+   void multi_transfer_token_operation::validate()const
+   {
+      try {
+         FC_ASSERT( is_valid_account_name( from ), "from ${n} is invalid.", ("n", from) );
+         FC_ASSERT( transfers.size() > 0, "There is no transfer." );
+         FC_ASSERT( transfers.size() <= SIGMAENGINE_MAX_TOKEN_TRANSFER_TARGETS
+            , "Too many transfers, maximum is ${m}.", ("m", SIGMAENGINE_MAX_TOKEN_TRANSFER_TARGETS) );
+         FC_ASSERT( memo.size() < SIGMAENGINE_MAX_MEMO_SIZE, "Memo is too large." );
+         FC_ASSERT( fc::is_utf8( memo ), "Memo is not UTF8." );
+
+         flat_set< account_name_type > recipients;
+         recipients.reserve( transfers.size() );
+         for( const auto& t : transfers )
+         {
+            FC_ASSERT( is_valid_account_name( t.to ), "to ${n} is invalid.", ("n", t.to) );
+            FC_ASSERT( t.to != from, "Cannot transfer to self." );
+            FC_ASSERT( t.amount.symbol == transfers.front().amount.symbol, "All transfers must use the same token." );
+            FC_ASSERT( t.amount.amount > 0, "transfer amount should be lager than 0." );
+            FC_ASSERT( recipients.insert( t.to ).second, "Duplicate recipient ${n}.", ("n", t.to) );
+         }
+      } FC_CAPTURE_AND_RETHROW( ( *this ) )
+   }
+
    void burn_token_operation::validate()const
    {
       try {
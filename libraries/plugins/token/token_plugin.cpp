@@ -48,76 +48,101 @@ namespace sigmaengine { namespace token {
          _custom_operation_interpreter->register_evaluator< transfer_token_savings_evaluator >( &_self );
          _custom_operation_interpreter->register_evaluator< cancel_transfer_token_savings_evaluator >( &_self );
          _custom_operation_interpreter->register_evaluator< conclude_transfer_token_savings_evaluator >( &_self );
+         _custom_operation_interpreter->register_evaluator< multi_transfer_token_evaluator >( &_self );
 
          database().set_custom_operation_interpreter( _self.plugin_name(), _custom_operation_interpreter );
       }
 
       void token_plugin_impl::process_token_fund_withdraw() {
          auto& _db = database();
-         
+         auto now = _db.head_block_time();
+
+         // ordered by due time, so only the withdrawals due in this block are visited
          const auto& idx = _db.get_index< token_fund_withdraw_index >().indices().get< by_complete >();
          auto itr = idx.begin();
-         while( itr != idx.end() ) {
-            if( itr->complete > _db.head_block_time() )
-               break;
+         if( itr == idx.end() || itr->complete > now )
+            return;
+
+         util::token_util utils(_db);
+         while( itr != idx.end() && itr->complete <= now ) {
+            const auto& withdraw = *itr;
+            ++itr;
 
             dlog( "process_token_fund_withdraw : from = ${f}, token = ${t}, amount = ${a}, complete = ${c}"
-               , ("f", itr->from)("t", itr->token)("a", itr->amount)("c", itr->complete) );
+               , ("f", withdraw.from)("t", withdraw.token)("a", withdraw.amount)("c", withdraw.complete) );
 
-            util::token_util utils(_db);
-            utils.adjust_token_fund_balance( itr->token, itr->fund_name, -itr->amount, -itr->amount );
-            utils.adjust_token_balance( itr->from, itr->token, itr->amount);
+            const auto& token = utils.get_token( withdraw.token );
+            utils.adjust_token_fund_balance( token, withdraw.fund_name, -withdraw.amount, -withdraw.amount );
+            utils.adjust_token_balance( withdraw.from, token, withdraw.amount);
 
             _db.push_virtual_operation( fill_token_staking_fund_operation( 
-               itr->from, itr->token, itr->fund_name, itr->amount, itr->request_id, to_string(itr->memo) ) );
+               withdraw.from, withdraw.token, withdraw.fund_name, withdraw.amount, withdraw.request_id, to_string(withdraw.memo) ) );
 
-            _db.remove( *itr );
-            itr = idx.begin();
+            _db.remove( withdraw );
          }
       }
 
       void token_plugin_impl::process_token_savings_withdraws() {
          auto& _db = database();
+         auto now = _db.head_block_time();
 
          const auto& withdraw_idx = _db.get_index< token_savings_withdraw_index >().indices().get< by_savings_next_date >();
          auto withdraw_itr = withdraw_idx.begin();
+         if( withdraw_itr == withdraw_idx.end() || withdraw_itr->next_date > now )
+            return;
 
-         auto now = _db.head_block_time();
          util::token_util utils(_db);
+         auto pay = [&]( const token_savings_withdraw_object& withdraw ) {
+            const auto& token = utils.get_token( withdraw.token );
+
+            if ( withdraw.split_pay_order == withdraw.split_pay_month ) { // last month
+               utils.adjust_token_savings_balance( withdraw.to, token, -( withdraw.amount ) );
+               utils.adjust_token_balance( withdraw.to, token, withdraw.amount );
 
-         while( withdraw_itr != withdraw_idx.end() ) {
-            if( withdraw_itr->next_date > now )
-               break;
-            
-            if ( withdraw_itr->split_pay_order == withdraw_itr->split_pay_month ) { // last month
-               utils.adjust_token_savings_balance( withdraw_itr->to, withdraw_itr->token, -( withdraw_itr->amount ) );
-               utils.adjust_token_balance( withdraw_itr->to, withdraw_itr->token, withdraw_itr->amount );
-
-               _db.push_virtual_operation( fill_transfer_token_savings_operation( withdraw_itr->from, withdraw_itr->to
-                  , withdraw_itr->token, withdraw_itr->request_id, withdraw_itr->amount, withdraw_itr->total_amount
-                  , withdraw_itr->split_pay_order, withdraw_itr->split_pay_month, to_string(withdraw_itr->memo) ) );
+               _db.push_virtual_operation( fill_transfer_token_savings_operation( withdraw.from, withdraw.to
+                  , withdraw.token, withdraw.request_id, withdraw.amount, withdraw.total_amount
+                  , withdraw.split_pay_order, withdraw.split_pay_month, to_string(withdraw.memo) ) );
                     
-               _db.remove( *withdraw_itr );
-               withdraw_itr = withdraw_idx.begin();
+               _db.remove( withdraw );
+               return false;
             } else {  // others
-               asset monthly_amount = withdraw_itr->total_amount;
-               monthly_amount.amount /= withdraw_itr->split_pay_month;
-               utils.adjust_token_savings_balance( withdraw_itr->to, withdraw_itr->token, -monthly_amount );
-               utils.adjust_token_balance( withdraw_itr->to, withdraw_itr->token, monthly_amount);
+               const asset& monthly_amount = withdraw.split_pay_amount;
+               utils.adjust_token_savings_balance( withdraw.to, token, -monthly_amount );
+               utils.adjust_token_balance( withdraw.to, token, monthly_amount);
 
-               _db.push_virtual_operation( fill_transfer_token_savings_operation( withdraw_itr->from, withdraw_itr->to, withdraw_itr->token
-                  , withdraw_itr->request_id, monthly_amount, withdraw_itr->total_amount
-                    , withdraw_itr->split_pay_order, withdraw_itr->split_pay_month, to_string(withdraw_itr->memo) ) );
+               _db.push_virtual_operation( fill_transfer_token_savings_operation( withdraw.from, withdraw.to, withdraw.token
+                  , withdraw.request_id, monthly_amount, withdraw.total_amount
+                    , withdraw.split_pay_order, withdraw.split_pay_month, to_string(withdraw.memo) ) );
 
-               _db.modify( *withdraw_itr, [&]( token_savings_withdraw_object & obj ) {
-                  obj.amount -= monthly_amount;
+               _db.modify( withdraw, [&]( token_savings_withdraw_object & obj ) {
+                  obj.amount -= obj.split_pay_amount;
                   obj.split_pay_order += 1;
                   obj.next_date += SIGMAENGINE_TRANSFER_SAVINGS_CYCLE;
                   obj.last_updated = now;
                });
-               withdraw_itr++;
+               return true;
+            }
+         };
+
+         if( !_db.has_hardfork( SIGMAENGINE_HARDFORK_0_2 ) ) {
+            // a rescheduled installment moves the entry further down the index and the walk goes on
+            // from there, so the due entries it moved past are paid in a later block
+            while( withdraw_itr != withdraw_idx.end() && withdraw_itr->next_date <= now ) {
+               if( pay( *withdraw_itr ) )
+                  withdraw_itr++;
+               else
+                  withdraw_itr = withdraw_idx.begin();
             }
+            return;
          }
+
+         // every entry due in this block is collected before installments move any of them, and paid once
+         vector< token_savings_withdraw_id_type > due;
+         for( ; withdraw_itr != withdraw_idx.end() && withdraw_itr->next_date <= now; ++withdraw_itr )
+            due.push_back( withdraw_itr->id );
+
+         for( const auto& id : due )
+            pay( _db.get( id ) );
       }
 
       void token_plugin_impl::on_apply_block( const signed_block& b ){
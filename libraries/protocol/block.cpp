@@ -1,6 +1,7 @@
 #include <sigmaengine/protocol/block.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/bitutil.hpp>
+#include <fc/thread/parallel.hpp>
 #include <algorithm>
 
 namespace sigmaengine { namespace protocol {
@@ -39,6 +40,9 @@ namespace sigmaengine { namespace protocol {
       return signee() == expected_signee;
    }
 
+   /// below this many transactions per thread the leaves are hashed on the calling thread
+   static const size_t merkle_leaves_per_thread = 256;
+
    checksum_type signed_block::calculate_merkle_root()const
    {
       if( transactions.size() == 0 )
@@ -46,8 +50,15 @@ namespace sigmaengine { namespace protocol {
 
       vector<digest_type> ids;
       ids.resize( transactions.size() );
-      for( uint32_t i = 0; i < transactions.size(); ++i )
-         ids[i] = transactions[i].merkle_digest();
+
+      fc::parallel_for( transactions.size(), merkle_leaves_per_thread, [&]( size_t begin, size_t end )
+      {
+         for( size_t i = begin; i < end; ++i )
+            ids[i] = transactions[i].merkle_digest();
+      } );
+
+      // a pair packs to its two digests back to back, which is how adjacent ids are laid out
+      static_assert( sizeof( digest_type ) == 32, "digests must be packed without padding" );
 
       vector<digest_type>::size_type current_number_of_hashes = ids.size();
       while( current_number_of_hashes > 1 )
@@ -57,7 +68,7 @@ namespace sigmaengine { namespace protocol {
          uint32_t k = 0;
 
          for( uint32_t i = 0; i < i_max; i += 2 )
-            ids[k++] = digest_type::hash( std::make_pair( ids[i], ids[i+1] ) );
+            ids[k++] = digest_type::hash( (const char*)&ids[i], 2 * sizeof( digest_type ) );
 
          if( current_number_of_hashes&1 )
             ids[k++] = ids[i_max];
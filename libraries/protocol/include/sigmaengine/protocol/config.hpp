@@ -4,7 +4,7 @@
 
 #define SIGMAENGINE_VERSION                                         ( version(0, 1, 2) )
 
-#define SIGMAENGINE_BLOCKCHAIN_VERSION                              ( version(0, 1, 0) )
+#define SIGMAENGINE_BLOCKCHAIN_VERSION                              ( version(0, 2, 0) )
 #define SIGMAENGINE_BLOCKCHAIN_HARDFORK_VERSION                     ( hardfork_version( SIGMAENGINE_BLOCKCHAIN_VERSION ) )
 
 #define SIGMAENGINE_BLOCKCHAIN_PRECISION_DIGITS                     8
@@ -90,6 +90,7 @@
 #define SIGMAENGINE_STAKING_INTEREST_PRECISION                      std::pow(10, SIGMAENGINE_STAKING_INTEREST_PRECISION_DIGITS )
 
 #define SIGMAENGINE_TOKEN_MAX                                         int64_t(90000000000ll)
+#define SIGMAENGINE_MAX_TOKEN_TRANSFER_TARGETS                      1000
 
 #define SIGMAENGINE_TRANSFER_SAVINGS_MIN_MONTH                      1
 #define SIGMAENGINE_TRANSFER_SAVINGS_MAX_MONTH                      24
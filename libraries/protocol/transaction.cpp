@@ -175,11 +175,16 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
 flat_set<public_key_type> signed_transaction::get_signature_keys( const chain_id_type& chain_id )const
 { try {
    auto d = sig_digest( chain_id );
+   vector< std::pair< fc::sha256, fc::ecc::compact_signature > > batch;
+   batch.reserve( signatures.size() );
+   for( const auto& sig : signatures )
+      batch.emplace_back( d, sig );
+
    flat_set<public_key_type> result;
-   for( const auto&  sig : signatures )
+   for( const auto& key : fc::ecc::public_key::recover( batch ) )
    {
       SIGMAENGINE_ASSERT(
-         result.insert( fc::ecc::public_key(sig,d) ).second,
+         result.insert( key ).second,
          tx_duplicate_sig,
          "Duplicate Signature detected" );
    }
@@ -3,6 +3,7 @@
 #include <sigmaengine/app/api.hpp>
 #include <sigmaengine/app/sigmaengine_api_objects.hpp>
 #include <sigmaengine/token/token_api.hpp>
+#include <sigmaengine/token/token_operations.hpp>
 #include <sigmaengine/dapp/dapp_api.hpp>
 #include <sigmaengine/dapp_history/dapp_history_api.hpp>
 #include <graphene/utilities/key_conversion.hpp>
@@ -742,6 +743,15 @@ class wallet_api
        * @param broadcast true if you wish to broadcast the transaction
        * */
       annotated_signed_transaction transfer_token( string from, string to, asset amount, string memo, bool broadcast = false );	  
+
+      /**
+       * transfer owned token to many accounts in one operation
+       * @param from The account the tokens are coming from
+       * @param transfers The recipients and amounts, i.e. [{"to":"alice","amount":"1.00000000 TEST"}]
+       * @param memo A memo shared by all transfers, stored in plain text
+       * @param broadcast true if you wish to broadcast the transaction
+       * */
+      annotated_signed_transaction multi_transfer_token( string from, vector< token_transfer_target > transfers, string memo, bool broadcast = false );
       
       /**
        * burn owned token 
@@ -1331,6 +1341,7 @@ FC_API( sigmaengine::wallet::wallet_api,
         ( get_token_balance )
         ( list_tokens )
         ( transfer_token )
+        ( multi_transfer_token )
         ( burn_token )
         ( get_accounts_by_token )
         ( get_tokens_by_dapp )
@@ -1428,6 +1428,34 @@ annotated_signed_transaction wallet_api::transfer_token( string from, string to,
    } FC_CAPTURE_AND_RETHROW( ( from )( to )( amount )( broadcast ) )
 }
 
+annotated_signed_transaction wallet_api::multi_transfer_token( string from, vector< token_transfer_target > transfers, string memo, bool broadcast )
+{
+   try {
+      FC_ASSERT(my->_wallet.ws_server != "local", "Wallet  is local mode.");
+      FC_ASSERT( !is_locked() );
+      check_memo( memo, get_account( from ) );
+
+      multi_transfer_token_operation op;
+
+      op.from = from;
+      op.transfers = transfers;
+      op.memo = memo;
+
+      token_operation plugin_op = op;
+
+      custom_json_dapp_operation custom_op;
+      custom_op.id = TOKEN_PLUGIN_NAME;
+      custom_op.json = fc::json::to_string( plugin_op );
+      custom_op.required_active_auths.insert( from );
+
+      signed_transaction tx;
+      tx.operations.push_back( custom_op );
+      tx.validate();
+
+      return my->sign_transaction( tx, broadcast );
+   } FC_CAPTURE_AND_RETHROW( ( from )( transfers )( broadcast ) )
+}
+
 annotated_signed_transaction wallet_api::burn_token( string account, asset amount, bool broadcast )
 {
    try {
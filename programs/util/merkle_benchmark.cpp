@@ -0,0 +1,90 @@
+
+#include <iostream>
+#include <string>
+
+#include <sigmaengine/protocol/block.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/time.hpp>
+
+using namespace sigmaengine::protocol;
+using std::vector;
+
+/// calculate_merkle_root as it was before leaves were hashed in parallel and pairs without packing them
+checksum_type reference_merkle_root( const signed_block& b )
+{
+   if( b.transactions.size() == 0 )
+      return checksum_type();
+
+   vector<digest_type> ids;
+   ids.resize( b.transactions.size() );
+   for( uint32_t i = 0; i < b.transactions.size(); ++i )
+   {
+      digest_type::encoder enc;
+      fc::raw::pack( enc, b.transactions[i] );
+      ids[i] = enc.result();
+   }
+
+   vector<digest_type>::size_type current_number_of_hashes = ids.size();
+   while( current_number_of_hashes > 1 )
+   {
+      uint32_t i_max = current_number_of_hashes - (current_number_of_hashes&1);
+      uint32_t k = 0;
+
+      for( uint32_t i = 0; i < i_max; i += 2 )
+         ids[k++] = digest_type::hash( std::make_pair( ids[i], ids[i+1] ) );
+
+      if( current_number_of_hashes&1 )
+         ids[k++] = ids[i_max];
+      current_number_of_hashes = k;
+   }
+   return checksum_type::hash( ids[0] );
+}
+
+signed_block make_block( uint32_t transaction_count )
+{
+   signed_block b;
+   for( uint32_t i = 0; i < transaction_count; ++i )
+   {
+      signed_transaction trx;
+      transfer_operation op;
+      op.from = "alice";
+      op.to = "bob";
+      op.amount = asset( i + 1 );
+      op.memo = std::to_string( i );
+      trx.operations.push_back( op );
+      trx.ref_block_num = i;
+      trx.signatures.push_back( signature_type() );
+      b.transactions.push_back( trx );
+   }
+   return b;
+}
+
+int main( int argc, char** argv, char** envp )
+{
+   // usage: merkle_benchmark [iterations]
+   uint32_t iterations = argc > 1 ? std::stoul( argv[1] ) : 100;
+
+   for( uint32_t count : { 1, 16, 256, 1024, 4096, 16384 } )
+   {
+      signed_block b = make_block( count );
+
+      checksum_type expected;
+      auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < iterations; ++i )
+         expected = reference_merkle_root( b );
+      auto reference_time = fc::time_point::now() - start;
+
+      checksum_type result;
+      start = fc::time_point::now();
+      for( uint32_t i = 0; i < iterations; ++i )
+         result = b.calculate_merkle_root();
+      auto current_time = fc::time_point::now() - start;
+
+      std::cout << count << " transactions: reference " << reference_time.count() / iterations << " us, current "
+                << current_time.count() / iterations << " us" << ( result == expected ? "" : "  MISMATCH" ) << "\n";
+      if( result != expected )
+         return 1;
+   }
+   return 0;
+}